@@ -48,7 +48,7 @@ int main()
 {
   Board board;
   string input;
-  board.setUp("////k2pP1R///K b - e3");
+  board.setUp("8/8/8/8/k2pP1R1/8/8/K7 b - e3");
 
   print(board.toString() + "\nSelect a piece by typing 'sel' or 'select',\nthen the adress of the piece.\nFor example: sel e2\nTo quit, type 'q' or 'quit' at any time.\n");
   getline(input);
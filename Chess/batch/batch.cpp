@@ -0,0 +1,184 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+bool Batch::parsePosition(const std::string& line, Board& board, std::string& fen) {
+  std::istringstream fields(line);
+  std::string field;
+  fen.clear();
+  for (int i = 0; i < 4; ++i) {
+    if (!(fields >> field)) return false;
+    if (i) fen += ' ';
+    fen += field;
+  }
+  // a FEN goes on with its two counters, where an EPD's operations start
+  for (int i = 0; i < 2 && fields >> field; ++i) {
+    if (field.find_first_not_of("0123456789") != std::string::npos) break;
+    fen += ' ' + field;
+  }
+  if (board.parseFen(fen.c_str()) != Board::FenError::none) return false;
+  // the search can't do without both kings
+  return Binary::countSetBits(board.getPieces(Piece::white_king)) == 1
+    && Binary::countSetBits(board.getPieces(Piece::black_king)) == 1;
+}
+
+std::string Batch::formatResult(const std::string& fen, const Search::Result& result) {
+  std::string line = fen + "; bestmove ";
+  line += (result.best_move.isNone()) ? "0000" : result.best_move.toUCI();
+  line += "; score ";
+  if (Search::isMateScore(result.score)) {
+    // in moves, not plies; negative when the side to move is getting mated
+    int plies = Search::score_mate - std::abs(result.score);
+    int moves = (plies + 1) / 2;
+    line += "mate " + std::to_string((result.score > 0) ? moves : -moves);
+  }
+  else line += "cp " + std::to_string(result.score);
+  line += "; depth " + std::to_string(result.depth)
+    + "; nodes " + std::to_string(result.nodes)
+    + "; time " + std::to_string(static_cast<int64_t>(result.seconds * 1000));
+  return line;
+}
+
+namespace {
+  // one line in flight: read into line, answered in output
+  struct Slot {
+    std::string line;
+    std::string output;
+    bool done = false;
+  };
+
+  // positions are numbered in the order they were read; position n lives
+  // in slots[n % window] from when it is read until it is written
+  struct Ring {
+    std::vector<Slot> slots;
+    std::mutex lock;
+    // signalled when a slot is filled, answered or freed
+    std::condition_variable changed;
+    // how many positions have been read, taken by a worker & written
+    uint64_t read = 0, taken = 0, written = 0;
+    bool end_of_input = false;
+
+    explicit Ring(size_t window) : slots(window) {}
+    inline Slot& slot(uint64_t n) noexcept { return slots[n % slots.size()]; }
+  };
+
+  inline bool isSkipped(const std::string& line) {
+    size_t start = line.find_first_not_of(" \t\r");
+    return start == std::string::npos || line[start] == '#';
+  }
+}
+
+Batch::Summary Batch::analyse(std::istream& in, std::ostream& out, const Options& options) {
+  auto start = std::chrono::steady_clock::now();
+  int num_threads = std::max(options.num_threads, 1);
+  size_t window = (options.window) ? options.window : 4 * static_cast<size_t>(num_threads);
+  Search::Limits limits;
+  limits.depth = options.limits.depth;
+  limits.nodes = options.limits.nodes;
+  if (limits.depth >= Search::max_ply - 1 && !limits.nodes) limits.depth = default_depth;
+
+  Ring ring(window);
+  Summary summary;
+
+  // each worker keeps its own table & searcher, so nothing is shared
+  // between searches but the ring
+  std::vector<std::thread> workers;
+  for (int id = 0; id < num_threads; ++id) {
+    workers.emplace_back([&]() {
+      Search::TranspositionTable tt(options.hash_mb);
+      std::atomic<bool> stop(false);
+      auto searcher = std::make_unique<Search::Searcher>(tt, stop);
+      Board board;
+      std::string line, fen;
+      uint64_t nodes = 0, errors = 0;
+      for (;;) {
+        uint64_t n;
+        {
+          std::unique_lock<std::mutex> guard(ring.lock);
+          ring.changed.wait(guard, [&]() { return ring.taken < ring.read || ring.end_of_input; });
+          if (ring.taken == ring.read) break;
+          n = ring.taken++;
+          line = std::move(ring.slot(n).line);
+        }
+        std::string output;
+        if (parsePosition(line, board, fen)) {
+          tt.newSearch();
+          Search::Result result = searcher->search(board, limits);
+          nodes += result.nodes;
+          output = formatResult(fen, result);
+        }
+        else {
+          ++errors;
+          output = line + "; error invalid position";
+        }
+        {
+          std::lock_guard<std::mutex> guard(ring.lock);
+          ring.slot(n).output = std::move(output);
+          ring.slot(n).done = true;
+        }
+        ring.changed.notify_all();
+      }
+      std::lock_guard<std::mutex> guard(ring.lock);
+      summary.nodes += nodes;
+      summary.errors += errors;
+    });
+  }
+
+  // the writer frees each slot once its line is out, letting the reader on
+  std::thread writer([&]() {
+    for (;;) {
+      std::string output;
+      {
+        std::unique_lock<std::mutex> guard(ring.lock);
+        ring.changed.wait(guard, [&]() {
+          return (ring.written < ring.read && ring.slot(ring.written).done)
+            || (ring.end_of_input && ring.written == ring.read);
+        });
+        if (ring.written == ring.read) break;
+        Slot& slot = ring.slot(ring.written);
+        output = std::move(slot.output);
+        slot.done = false;
+      }
+      out << output << '\n';
+      {
+        std::lock_guard<std::mutex> guard(ring.lock);
+        ++ring.written;
+      }
+      ring.changed.notify_all();
+    }
+    out.flush();
+  });
+
+  std::string line;
+  while (std::getline(in, line)) {
+    if (isSkipped(line)) continue;
+    {
+      std::unique_lock<std::mutex> guard(ring.lock);
+      ring.changed.wait(guard, [&]() { return ring.read - ring.written < window; });
+      ring.slot(ring.read).line = std::move(line);
+      ++ring.read;
+    }
+    ring.changed.notify_all();
+  }
+  {
+    std::lock_guard<std::mutex> guard(ring.lock);
+    ring.end_of_input = true;
+    summary.positions = ring.read;
+  }
+  ring.changed.notify_all();
+
+  for (std::thread& worker : workers) worker.join();
+  writer.join();
+  summary.positions -= summary.errors;
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  summary.seconds = elapsed.count();
+  return summary;
+}
@@ -0,0 +1,65 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// defines batch analysis: a stream of positions (one FEN or EPD per line)
+// is searched to a fixed depth or node count on a pool of worker threads,
+// & one result line is written per position, in the order they were read.
+// the reader, the workers & the writer share a ring of slots, so at most
+// window positions are in flight at once however long the input is: the
+// reader waits for the writer when the ring is full, & the writer waits
+// for the slot of the next position in order when its worker is behind
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "../board/board.h"
+#include "../search/search.h"
+
+namespace Batch {
+  struct Options {
+    // the search run on every position; only depth & nodes are used
+    // (with neither set, the depth defaults to default_depth)
+    Search::Limits limits;
+    int num_threads = 1;
+    // the transposition table of each worker, kept between its positions
+    size_t hash_mb = 16;
+    // how many positions may be read ahead of the one being written,
+    // 0 for 4 per thread
+    size_t window = 0;
+  };
+
+  constexpr int default_depth = 8;
+
+  struct Summary {
+    uint64_t positions = 0;
+    // lines that weren't a valid position
+    uint64_t errors = 0;
+    uint64_t nodes = 0;
+    double seconds = 0;
+
+    inline double positionsPerSecond() const noexcept {
+      return (seconds > 0) ? positions / seconds : 0;
+    }
+  };
+
+  // reads the position at the start of a FEN or EPD line onto board: the
+  // four fields of placement, side, castling & en passant, then the two
+  // counters of a FEN (the operations of an EPD are skipped)
+  // fen is set to the fields read, for echoing in the result
+  // returns false if the line doesn't start with a valid position
+  bool parsePosition(const std::string& line, Board& board, std::string& fen);
+
+  // the result line for a searched position:
+  // "<fen>; bestmove e2e4; score cp 25; depth 8; nodes 12345; time 12"
+  // (the time in ms, & "score mate n" in moves once a mate is found)
+  std::string formatResult(const std::string& fen, const Search::Result& result);
+
+  // analyses every line of in, writing one line per position to out
+  // blank lines & lines starting with '#' are skipped; any other line that
+  // isn't a valid position gets "<line>; error invalid position"
+  Summary analyse(std::istream& in, std::ostream& out, const Options& options);
+}
+
+#endif // BATCH_H
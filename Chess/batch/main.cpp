@@ -0,0 +1,64 @@
+// batch analysis driver
+//
+// searches every position (one FEN or EPD per line) of a file, or of stdin
+// if none is given, & prints one result line per position in input order
+//
+// usage:
+//   ChessBatch [-t <threads>] [-d <depth> | -n <nodes>] [-H <hash_mb>] [file]
+//
+// the depth defaults to Batch::default_depth; a summary goes to stderr
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "batch.h"
+
+using std::cerr, std::endl;
+
+static int usage() {
+  cerr << "usage: ChessBatch [-t <threads>] [-d <depth> | -n <nodes>] [-H <hash_mb>] [file]" << endl;
+  return 1;
+}
+
+int main(int argc, char* argv[]) {
+  std::ios::sync_with_stdio(false);
+  Batch::Options options;
+  const char* path = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg[0] != '-') {
+      if (path) return usage();
+      path = argv[i];
+      continue;
+    }
+    if (i + 1 >= argc) return usage();
+    long value = std::atol(argv[++i]);
+    if (value <= 0) return usage();
+    if (arg == "-t") options.num_threads = static_cast<int>(value);
+    else if (arg == "-d") options.limits.depth = static_cast<int>(std::min(value, static_cast<long>(Search::max_ply - 1)));
+    else if (arg == "-n") options.limits.nodes = static_cast<uint64_t>(value);
+    else if (arg == "-H") options.hash_mb = static_cast<size_t>(value);
+    else return usage();
+  }
+
+  Batch::Summary summary;
+  if (path) {
+    std::ifstream file(path);
+    if (!file) {
+      cerr << "Can't open " << path << endl;
+      return 1;
+    }
+    summary = Batch::analyse(file, std::cout, options);
+  }
+  else summary = Batch::analyse(std::cin, std::cout, options);
+
+  cerr << "positions: " << summary.positions << "  errors: " << summary.errors
+    << "  nodes: " << summary.nodes
+    << "  time: " << std::fixed << std::setprecision(3) << summary.seconds << "s"
+    << "  positions/s: " << std::setprecision(1) << summary.positionsPerSecond() << endl;
+  return (summary.errors) ? 2 : 0;
+}
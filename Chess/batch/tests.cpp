@@ -0,0 +1,146 @@
+#include "batch.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::cout, std::endl;
+
+namespace {
+  std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) lines.push_back(line);
+    return lines;
+  }
+
+  // the value after "<name> " in a result line, or "" if there is none
+  std::string field(const std::string& line, const std::string& name) {
+    size_t at = line.find("; " + name + " ");
+    if (at == std::string::npos) return "";
+    size_t start = at + name.size() + 3;
+    return line.substr(start, line.find(';', start) - start);
+  }
+
+  const char* positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - bm Rxb4; id \"position 3\";",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+  };
+}
+
+int main() {
+  cout << "Testing batch analysis...\n- Parses FEN & EPD lines...";
+  {
+    Board board;
+    std::string fen;
+    bool fen_ok = Batch::parsePosition("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", board, fen);
+    std::string fen_expected = "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1";
+    std::string epd_fen;
+    bool epd_ok = Batch::parsePosition("  6k1/5ppp/8/8/8/8/8/R5K1  w - - bm Ra8#; id \"mate\";", board, epd_fen);
+    std::string epd_expected = "6k1/5ppp/8/8/8/8/8/R5K1 w - -";
+    if (!fen_ok || fen != fen_expected) cout << "[FAIL] FEN read as \"" << fen << "\"" << endl;
+    else if (!epd_ok || epd_fen != epd_expected) cout << "[FAIL] EPD read as \"" << epd_fen << "\"" << endl;
+    else if (Batch::parsePosition("not a position", board, fen)
+      || Batch::parsePosition("8/8/8/8/8/8/8/8 w - -", board, fen)
+      || Batch::parsePosition("6k1/5ppp/8/8/8/8/8/R5K1 w", board, fen))
+      cout << "[FAIL] Accepted an invalid position" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Reports mates in moves...";
+  {
+    std::istringstream in("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1\n");
+    std::ostringstream out;
+    Batch::Options options;
+    options.limits.depth = 4;
+    options.hash_mb = 1;
+    Batch::analyse(in, out, options);
+    std::string line = out.str();
+    if (field(line, "bestmove") != "a1a8" || field(line, "score") != "mate 1")
+      cout << "[FAIL] Expected a1a8 & mate 1, got " << line;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Keeps the FEN counters...";
+  {
+    // every move runs out the 50 move rule
+    std::istringstream in("7k/8/8/8/8/8/8/K6R w - - 99 80\n");
+    std::ostringstream out;
+    Batch::Options options;
+    options.limits.depth = 5;
+    options.hash_mb = 1;
+    Batch::analyse(in, out, options);
+    std::string line = out.str();
+    if (line.compare(0, 31, "7k/8/8/8/8/8/8/K6R w - - 99 80;") != 0 || field(line, "score") != "cp 0")
+      cout << "[FAIL] Expected the counters echoed & a draw score, got " << line;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Writes results in input order...";
+  {
+    // more positions than the window, over more threads than one, with
+    // comments, blank lines & a bad line mixed in
+    std::ostringstream text;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 30; ++i) {
+      if (i % 7 == 3) text << "# comment\n\n";
+      if (i == 17) {
+        text << "junk\n";
+        expected.push_back("junk; error invalid position");
+      }
+      const char* position = positions[i % (sizeof(positions) / sizeof(positions[0]))];
+      text << position << '\n';
+      Board board;
+      std::string fen;
+      Batch::parsePosition(position, board, fen);
+      expected.push_back(fen);
+    }
+    std::istringstream in(text.str());
+    std::ostringstream out;
+    Batch::Options options;
+    options.limits.depth = 3;
+    options.num_threads = 4;
+    options.window = 3;
+    options.hash_mb = 1;
+    Batch::Summary summary = Batch::analyse(in, out, options);
+    std::vector<std::string> lines = splitLines(out.str());
+
+    std::string failure;
+    if (lines.size() != expected.size())
+      failure = "Expected " + std::to_string(expected.size()) + " lines, got " + std::to_string(lines.size());
+    else if (summary.positions != 30 || summary.errors != 1)
+      failure = "Expected 30 positions & 1 error, got " + std::to_string(summary.positions)
+        + " & " + std::to_string(summary.errors);
+    for (size_t i = 0; failure.empty() && i < lines.size(); ++i) {
+      if (lines[i].compare(0, expected[i].size(), expected[i]) != 0)
+        failure = "Line " + std::to_string(i) + " out of order: " + lines[i];
+      else if (expected[i].find("error") == std::string::npos
+        && (field(lines[i], "bestmove").size() < 4 || field(lines[i], "depth") != "3"))
+        failure = "Line " + std::to_string(i) + " is missing its result: " + lines[i];
+    }
+    if (!failure.empty()) cout << "[FAIL] " << failure << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Stops at the node limit...";
+  {
+    std::istringstream in(std::string(positions[1]) + "\n" + positions[5] + "\n");
+    std::ostringstream out;
+    Batch::Options options;
+    options.limits.nodes = 20000;
+    options.num_threads = 2;
+    options.hash_mb = 1;
+    Batch::analyse(in, out, options);
+    std::string failure;
+    for (const std::string& line : splitLines(out.str())) {
+      // the limit is checked every 4096 nodes
+      uint64_t nodes = std::stoull("0" + field(line, "nodes"));
+      if (!nodes || nodes > options.limits.nodes + 4096) failure = line;
+    }
+    if (!failure.empty()) cout << "[FAIL] Node limit ignored: " << failure << endl;
+    else cout << "[PASS]" << endl;
+  }
+  return 0;
+}
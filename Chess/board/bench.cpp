@@ -0,0 +1,126 @@
+// position encoding benchmark
+//
+// collects positions from random games, then times how many positions per
+// second parseFen() reads & toFen() writes, & the same for unpack() & pack()
+// (see packed.h), over a few passes of the whole set
+//
+// usage:
+//   benchFen [positions] [passes]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+using std::cout, std::endl;
+
+namespace {
+  const char* const start_positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+  };
+
+  uint64_t rand64(uint64_t& state) noexcept {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545f4914f6cdd1d;
+  }
+
+  // the FENs of the positions along random games, up to count of them
+  std::vector<std::string> collectFens(size_t count) {
+    std::vector<std::string> fens;
+    uint64_t seed = 0x9e3779b97f4a7c15;
+    for (size_t game = 0; fens.size() < count; ++game) {
+      Board board;
+      board.setUp(start_positions[game % (sizeof(start_positions) / sizeof(start_positions[0]))]);
+      for (int ply = 0; ply < 120 && fens.size() < count; ++ply) {
+        fens.push_back(board.toFen());
+        std::vector<Move> moves = board.getAllMoves();
+        if (moves.empty()) break;
+        board.makeMove(moves[rand64(seed) % moves.size()]);
+      }
+    }
+    return fens;
+  }
+
+  void report(const char* label, size_t count, double seconds) {
+    cout << std::left << std::setw(8) << label << std::right << std::fixed
+      << std::setprecision(2) << std::setw(8) << count / seconds / 1e6 << "M positions/s"
+      << std::setprecision(1) << std::setw(8) << seconds * 1e9 / count << " ns/position" << endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t num_positions = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  int passes = (argc > 2) ? std::atoi(argv[2]) : 10;
+  if (!num_positions || passes <= 0) {
+    cout << "usage: benchFen [positions] [passes]" << endl;
+    return 1;
+  }
+
+  std::vector<std::string> fens = collectFens(num_positions);
+  size_t total = fens.size() * passes;
+  cout << fens.size() << " positions x " << passes << " passes" << endl;
+
+  // sum the keys & lengths, so neither loop can be optimised away
+  uint64_t check = 0;
+  Board board;
+  auto start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; ++pass) {
+    for (const std::string& fen : fens) {
+      if (board.parseFen(fen.c_str()) != Board::FenError::none) {
+        cout << "[FAIL] couldn't read " << fen << endl;
+        return 1;
+      }
+      check += board.getKey();
+    }
+  }
+  std::chrono::duration<double> parsing = std::chrono::steady_clock::now() - start;
+
+  std::vector<Board> boards(fens.size());
+  for (size_t i = 0; i < fens.size(); ++i) boards[i].parseFen(fens[i].c_str());
+  char buf[Board::max_fen_length];
+  start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; ++pass) {
+    for (const Board& position : boards) check += position.toFen(buf, sizeof(buf));
+  }
+  std::chrono::duration<double> writing = std::chrono::steady_clock::now() - start;
+
+  std::vector<Packed::Position> packed(boards.size());
+  start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; ++pass) {
+    for (size_t i = 0; i < boards.size(); ++i) check += boards[i].pack(packed[i]);
+  }
+  std::chrono::duration<double> packing = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; ++pass) {
+    for (const Packed::Position& position : packed) {
+      if (!board.unpack(position)) {
+        cout << "[FAIL] couldn't unpack a packed position" << endl;
+        return 1;
+      }
+      check += board.getKey();
+    }
+  }
+  std::chrono::duration<double> unpacking = std::chrono::steady_clock::now() - start;
+
+  size_t fen_bytes = 0;
+  for (const std::string& fen : fens) fen_bytes += fen.size() + 1;
+  cout << "FEN: " << std::fixed << std::setprecision(1) << static_cast<double>(fen_bytes) / fens.size()
+    << " bytes/position (with a newline), packed: " << Packed::position_size << endl;
+  report("parse", total, parsing.count());
+  report("write", total, writing.count());
+  report("unpack", total, unpacking.count());
+  report("pack", total, packing.count());
+  cout << "(checksum " << std::hex << check << std::dec << ")" << endl;
+  return 0;
+}
@@ -16,9 +16,5 @@ vector<bb> Bitboards::getEachPiece(bb board) noexcept {
 }
 
 void Bitboards::buffer(bb board, string& buf, char one) {
-  while (board) {
-    size_t idx = indexOfMS1B(board);
-    buf[idx] = one;
-    board ^= isolateMS1B(board);
-  }
+  while (board) buf[popLS1B(&board)] = one;
 }
@@ -1,6 +1,7 @@
 #ifndef BITBOARDS_H
 #define BITBOARDS_H
 
+#include <array>
 #include <vector>
 #include <string>
 #include <sstream>
@@ -32,7 +33,7 @@ namespace Bitboards {
     g = 0x00ff000000000000, h = 0xff00000000000000
   };
   // indexed list of columns for easy lookup
-  constexpr inline File files[8] = { a, b, c, d, e, f, g };
+  constexpr inline File files[8] = { a, b, c, d, e, f, g, h };
   // mask representing each rank
   // for example, row 1 is the lowest bit in every byte,
   // or 0x0101010101010101, while row 8 is the highest bit
@@ -146,6 +147,42 @@ namespace Bitboards {
   constexpr inline bb shiftSSE(const bb& board) noexcept { return (board << Indexing::s_s_east) & dbl_south_mask; }
   constexpr inline bb shiftSSW(const bb& board) noexcept { return (board >> -Indexing::s_s_west) & dbl_south_mask; }
 
+  // single-square attack tables, generated at compile time from the shifts above
+  // (the set-wise shift versions in Movegen are still used for whole threat maps)
+
+  // indexed by square
+  constexpr inline std::array<bb, 64> knight_attacks = [] {
+    std::array<bb, 64> attacks{};
+    for (int idx = 0; idx < 64; ++idx) {
+      bb knight = 1ULL << idx;
+      bb we_1 = shiftW(knight) | shiftE(knight);
+      bb we_2 = shift2W(knight) | shift2E(knight);
+      attacks[idx] = shift2N(we_1) | shiftN(we_2) | shiftS(we_2) | shift2S(we_1);
+    }
+    return attacks;
+  }();
+  // indexed by square
+  constexpr inline std::array<bb, 64> king_attacks = [] {
+    std::array<bb, 64> attacks{};
+    for (int idx = 0; idx < 64; ++idx) {
+      bb king = 1ULL << idx;
+      bb row = king | shiftW(king) | shiftE(king);
+      attacks[idx] = (row | shiftN(row) | shiftS(row)) & ~king;
+    }
+    return attacks;
+  }();
+  // the squares a pawn captures on, indexed [is_white][square]
+  constexpr inline std::array<std::array<bb, 64>, 2> pawn_attacks = [] {
+    std::array<std::array<bb, 64>, 2> attacks{};
+    for (int idx = 0; idx < 64; ++idx) {
+      bb pawn = 1ULL << idx;
+      bb we = shiftW(pawn) | shiftE(pawn);
+      attacks[0][idx] = shiftS(we);
+      attacks[1][idx] = shiftN(we);
+    }
+    return attacks;
+  }();
+
   // when available_squares is the result of a castShadow call, this performs an obstructed fill
 
   constexpr inline bb castRayN(bb pieces, bb available_squares = -1) noexcept {
@@ -290,6 +327,23 @@ namespace Bitboards {
     return pieces;
   }
 
+  // sliding attacks found with Kogge-Stone fills, for any number of pieces at once
+  // the attacks of each piece include the first unavailable square along each ray
+  // (this is the reference implementation for the tables in magic.h)
+
+  constexpr inline bb fillBishopAttacks(bb pieces, bb empty_squares) noexcept {
+    return shiftNW(obstructedFillNW(pieces, empty_squares))
+      | shiftNE(obstructedFillNE(pieces, empty_squares))
+      | shiftSW(obstructedFillSW(pieces, empty_squares))
+      | shiftSE(obstructedFillSE(pieces, empty_squares));
+  }
+  constexpr inline bb fillRookAttacks(bb pieces, bb empty_squares) noexcept {
+    return shiftN(obstructedFillN(pieces, empty_squares))
+      | shiftE(obstructedFillE(pieces, empty_squares))
+      | shiftS(obstructedFillS(pieces, empty_squares))
+      | shiftW(obstructedFillW(pieces, empty_squares));
+  }
+
   // Isolates each set bit of the bitboard, from most significant to least significant
   std::vector<bb> getEachPiece(bb board) noexcept;
 
@@ -0,0 +1,119 @@
+#include "magic.h"
+
+#include <cassert>
+
+using namespace Binary;
+using namespace Bitboards;
+
+Magic Bitboards::bishop_magics[64];
+Magic Bitboards::rook_magics[64];
+bb Bitboards::between_table[64][64];
+bb Bitboards::line_table[64][64];
+
+namespace {
+  // each square gets 2^(squares in its mask) entries
+  bb bishop_table[0x1480];
+  bb rook_table[0x19000];
+
+  // xorshift64*, seeded so the magics found are the same every run
+  uint64_t rand64(uint64_t& state) noexcept {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545f4914f6cdd1d;
+  }
+  // magics with few set bits are found much faster
+  uint64_t sparseRand64(uint64_t& state) noexcept {
+    return rand64(state) & rand64(state) & rand64(state);
+  }
+
+  typedef bb (*FillAttacks)(bb, bb);
+
+  // fills in the Magic & attack table entries of every square for one slider
+  // returns the end of the entries used in table
+  bb* initSlider(Magic* magics, bb* table, FillAttacks fill) noexcept {
+    bb occupancies[4096], reference[4096];
+    int epoch[4096] = {};
+    int attempt = 0;
+    uint64_t seed = 0x9e3779b97f4a7c15;
+
+    bb* attacks = table;
+    for (int idx = 0; idx < 64; ++idx) {
+      Magic& m = magics[idx];
+      bb square = idxToBoard(idx);
+      // pieces on the board edge can't block anything further
+      bb edges = ((r1 | r8) & ~rowToBoard(Indexing::getRankIDX(idx)))
+        | ((a | h) & ~colToBoard(Indexing::getFileIDX(idx)));
+      m.mask = fill(square, ~0ULL) & ~edges;
+      m.shift = 64 - countSetBits(m.mask);
+      m.attacks = attacks;
+
+      // enumerate every subset of the mask (the Carry-Rippler trick)
+      int size = 0;
+      bb occupied = 0;
+      do {
+        occupancies[size] = occupied;
+        reference[size] = fill(square, ~occupied);
+        ++size;
+        occupied = (occupied - m.mask) & m.mask;
+      } while (occupied);
+
+#if MAGIC_USES_PEXT
+      m.magic = 0;
+      for (int i = 0; i < size; ++i) attacks[m.index(occupancies[i])] = reference[i];
+#else
+      // try random magics until one maps every occupancy to a slot without
+      // conflicting with a different attack set
+      for (bool found = false; !found; ) {
+        m.magic = sparseRand64(seed);
+        if (countSetBits((m.mask * m.magic) >> 56) < 6) continue;
+        ++attempt;
+        found = true;
+        for (int i = 0; i < size && found; ++i) {
+          unsigned index = m.index(occupancies[i]);
+          if (epoch[index] < attempt) {
+            epoch[index] = attempt;
+            attacks[index] = reference[i];
+          }
+          else if (attacks[index] != reference[i]) found = false;
+        }
+      }
+#endif
+      attacks += size;
+    }
+    return attacks;
+  }
+
+  bb fillBishop(bb pieces, bb empty_squares) { return fillBishopAttacks(pieces, empty_squares); }
+  bb fillRook(bb pieces, bb empty_squares) { return fillRookAttacks(pieces, empty_squares); }
+
+  // fills in between_table & line_table from the finished attack tables
+  void initLines() noexcept {
+    for (int from = 0; from < 64; ++from) {
+      for (int to = 0; to < 64; ++to) {
+        bb ends = idxToBoard(from) | idxToBoard(to);
+        if (from == to) continue;
+        if (bishopAttacks(from, 0) & idxToBoard(to)) {
+          between_table[from][to] = bishopAttacks(from, ends) & bishopAttacks(to, ends);
+          line_table[from][to] = (bishopAttacks(from, 0) & bishopAttacks(to, 0)) | ends;
+        }
+        else if (rookAttacks(from, 0) & idxToBoard(to)) {
+          between_table[from][to] = rookAttacks(from, ends) & rookAttacks(to, ends);
+          line_table[from][to] = (rookAttacks(from, 0) & rookAttacks(to, 0)) | ends;
+        }
+      }
+    }
+  }
+
+  // builds the tables during static initialization
+  const bool initialized = [] {
+    bb* bishop_end = initSlider(bishop_magics, bishop_table, fillBishop);
+    bb* rook_end = initSlider(rook_magics, rook_table, fillRook);
+    assert(bishop_end == bishop_table + sizeof(bishop_table) / sizeof(bb));
+    assert(rook_end == rook_table + sizeof(rook_table) / sizeof(bb));
+    initLines();
+    (void)bishop_end;
+    (void)rook_end;
+    return true;
+  }();
+}
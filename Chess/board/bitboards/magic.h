@@ -0,0 +1,72 @@
+#ifndef MAGIC_H
+#define MAGIC_H
+
+// defines precomputed sliding piece attack tables.
+// the squares that could block a slider are gathered into a dense index,
+// either by multiplying with a "magic" number & shifting, or (when built
+// with CHESS_USE_PEXT on a BMI2 cpu) with a single PEXT instruction,
+// so every bishop/rook attack set is one table lookup
+//
+// For more info, read https://www.chessprogramming.org/Magic_Bitboards
+
+#include "bitboards.h"
+
+#if defined(USE_PEXT) && defined(__BMI2__)
+#include <immintrin.h>
+#define MAGIC_USES_PEXT 1
+#else
+#define MAGIC_USES_PEXT 0
+#endif
+
+namespace Bitboards {
+  struct Magic {
+    // the squares whose occupancy affects the attacks
+    // (the rays from the square, minus the board edge)
+    bb mask;
+    bb magic;
+    // where this square's attacks start in the shared table
+    const bb* attacks;
+    unsigned shift;
+
+    inline unsigned index(bb occupied) const noexcept {
+#if MAGIC_USES_PEXT
+      return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+      return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+    }
+  };
+
+  // indexed by square, filled in before main() runs
+  extern Magic bishop_magics[64];
+  extern Magic rook_magics[64];
+
+  // the squares a bishop on square idx attacks, including the first
+  // occupied square (of either color) along each diagonal
+  inline bb bishopAttacks(int idx, bb occupied) noexcept {
+    const Magic& m = bishop_magics[idx];
+    return m.attacks[m.index(occupied)];
+  }
+  // the squares a rook on square idx attacks, including the first
+  // occupied square (of either color) along each line
+  inline bb rookAttacks(int idx, bb occupied) noexcept {
+    const Magic& m = rook_magics[idx];
+    return m.attacks[m.index(occupied)];
+  }
+  inline bb queenAttacks(int idx, bb occupied) noexcept {
+    return bishopAttacks(idx, occupied) | rookAttacks(idx, occupied);
+  }
+
+  // indexed by [from][to], filled in alongside the attack tables
+  extern bb between_table[64][64];
+  extern bb line_table[64][64];
+
+  // the squares strictly between two squares sharing a line or diagonal
+  // (empty if they don't share one)
+  inline bb squaresBetween(int from, int to) noexcept { return between_table[from][to]; }
+  // the whole line or diagonal running through both squares, edge to edge
+  // (empty if they don't share one)
+  inline bb lineThrough(int from, int to) noexcept { return line_table[from][to]; }
+}
+
+#endif // MAGIC_H
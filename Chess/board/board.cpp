@@ -1,81 +1,284 @@
 #include "board.h"
 
+#include <cstring>
+#include <stdexcept>
+
 using namespace Binary;
 using namespace Bitboards;
 using namespace Indexing;
 
-void Board::setUp(const char* fen) {
-  // https://en.wikipedia.org/wiki/Forsyth%E2%80%93Edwards_Notation
+namespace {
+  // the piece of each color & type index, as placed by placePiece()
+  constexpr Piece::Name pieces_by_type[2][6] = {
+    { Piece::black_pawn, Piece::black_knight, Piece::black_bishop,
+      Piece::black_rook, Piece::black_queen, Piece::black_king },
+    { Piece::white_pawn, Piece::white_knight, Piece::white_bishop,
+      Piece::white_rook, Piece::white_queen, Piece::white_king },
+  };
+
+  // maps each FEN piece letter to its type index, plus 8 for white
+  // (as in a packed nibble), & anything else to no_piece
+  constexpr uint8_t no_piece = 0xff;
+  constexpr std::array<uint8_t, 128> fen_pieces = []() {
+    std::array<uint8_t, 128> table{};
+    for (uint8_t& entry : table) entry = no_piece;
+    for (int is_white = 0; is_white < 2; ++is_white) {
+      for (int type = 0; type < 6; ++type)
+        table[static_cast<uint8_t>(pieces_by_type[is_white][type])] = static_cast<uint8_t>(type | (is_white << 3));
+    }
+    return table;
+  }();
+
+  inline bool isFenSpace(char c) noexcept { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+  // skips the spaces before the next field; false if there are none
+  inline bool skipFenSpaces(const char*& c) noexcept {
+    if (!isFenSpace(*c)) return false;
+    while (isFenSpace(*c)) ++c;
+    return true;
+  }
+  // reads a counter, which has to fit in 16 bits
+  inline bool readFenNumber(const char*& c, uint16_t& number) noexcept {
+    uint32_t value = 0;
+    const char* start = c;
+    for (; '0' <= *c && *c <= '9'; ++c) {
+      value = value * 10 + (*c - '0');
+      if (value > 0xffff) return false;
+    }
+    number = static_cast<uint16_t>(value);
+    return c != start && (*c == '\0' || isFenSpace(*c));
+  }
+  // writes number in decimal at out, returning the end of the digits
+  inline char* writeFenNumber(char* out, unsigned number) noexcept {
+    char digits[5];
+    int n = 0;
+    do {
+      digits[n++] = static_cast<char>('0' + number % 10);
+      number /= 10;
+    } while (number);
+    while (n) *out++ = digits[--n];
+    return out;
+  }
+}
+
+const char* Board::describe(FenError error) noexcept {
+  switch (error) {
+  case FenError::none: return "no error";
+  case FenError::placement: return "bad piece placement";
+  case FenError::side_to_move: return "bad side to move";
+  case FenError::castling: return "bad castling rights";
+  case FenError::en_passant: return "bad en passant square";
+  case FenError::halfmove_clock: return "bad halfmove clock";
+  case FenError::fullmove_number: return "bad fullmove number";
+  default: return "unexpected text after the fullmove number";
+  }
+}
+
+Board::FenError Board::parseFen(const char* fen) noexcept {
   clear();
 
-#define THROW_INVALID_FEN throw std::invalid_argument("Invalid FEN")
-  if (fen == nullptr) THROW_INVALID_FEN;
-  size_t i = 0;
+#define FEN_ERROR(error) do { clear(); return FenError::error; } while (false)
+  if (fen == nullptr) FEN_ERROR(placement);
+  const char* c = fen;
+  while (isFenSpace(*c)) ++c;
 
-  // parse the piece placement data ("rnbqkbnr/pppppppp/...")
+  // parse the piece placement data ("rnbqkbnr/pppppppp/...") from a8 to h1,
+  // every rank being exactly 8 squares
   int col = 0, row = 7;
-  for (; fen[i] != ' '; ++i) {
-    if (fen[i] == '\0') THROW_INVALID_FEN; // fen ended early
-    else if ('0' < fen[i] && fen[i] <= '8') {
-      // skip columns according to the specified number
-      col += fen[i] - '0';
+  for (; *c != '\0' && !isFenSpace(*c); ++c) {
+    if ('1' <= *c && *c <= '8') {
+      col += *c - '0';
+      if (col > 8) FEN_ERROR(placement);
     }
-    else if (fen[i] == '/') {
-      // skip to the next row
+    else if (*c == '/') {
+      if (col != 8 || row == 0) FEN_ERROR(placement);
       --row;
       col = 0;
     }
-    else if (Piece::isValidName(fen[i])) {
-      if (col < 0 || col >= 8 || row < 0 || row >= 8) THROW_INVALID_FEN; // too many board squares
-      pushPiece(static_cast<Piece::Name>(fen[i]), getIDX(row, col));
-      ++col;  // move to the next square
+    else {
+      uint8_t piece = (*c & 0x80) ? no_piece : fen_pieces[static_cast<uint8_t>(*c)];
+      if (piece == no_piece || col >= 8) FEN_ERROR(placement);
+      placePiece(piece >> 3, piece & 0x7, getIDX(row, col));
+      ++col;
     }
-    else THROW_INVALID_FEN; // not sure why this would be triggered
   }
-  // parse the side to move
-  ++i;
-  switch (fen[i]) {
-  case 'w':
-    makeWhitesMove();
-    break;
-  case 'b':
-    makeBlacksMove();
-    break;
-  default: THROW_INVALID_FEN;
-  }
-  ++i;
-  if (fen[i] != ' ') THROW_INVALID_FEN;
-  ++i;
-  for (; fen[i] != ' '; ++i) {
-    switch (fen[i]) {
-    case 'K': flags |= w_castle_kingside;
-      break;
-    case 'Q': flags |= w_castle_queenside;
-      break;
-    case 'k': flags |= b_castle_kingside;
-      break;
-    case 'q': flags |= b_castle_queenside;
-      break;
-    case '-': break;
-    default: THROW_INVALID_FEN;
+  if (row != 0 || col != 8) FEN_ERROR(placement);
+
+  // parse the side to move (the cleared board has black to move)
+  if (!skipFenSpaces(c)) FEN_ERROR(side_to_move);
+  if (*c == 'w') switchMoveSide();
+  else if (*c != 'b') FEN_ERROR(side_to_move);
+  ++c;
+
+  // parse the castling rights ("KQkq", any of them, or "-")
+  if (!skipFenSpaces(c)) FEN_ERROR(castling);
+  uint8_t castling = 0;
+  if (*c == '-') ++c;
+  else {
+    for (; *c != '\0' && !isFenSpace(*c); ++c) {
+      uint8_t right;
+      switch (*c) {
+      case 'K': right = w_castle_kingside; break;
+      case 'Q': right = w_castle_queenside; break;
+      case 'k': right = b_castle_kingside; break;
+      case 'q': right = b_castle_queenside; break;
+      default: FEN_ERROR(castling);
+      }
+      if (castling & right) FEN_ERROR(castling);
+      castling |= right;
     }
+    if (!castling) FEN_ERROR(castling);
   }
-  ++i;
-  if (fen[i] != '-') {
-    if ('a' > fen[i] || fen[i] > 'h') THROW_INVALID_FEN;
-    ++i;
-    if ('1' > fen[i] || fen[i] > '8') THROW_INVALID_FEN;
-    en_passant_square = Indexing::getIDX(fen[i] - '1', fen[i - 1] - 'a');
+  setCastlingFlags(castling);
+
+  // parse the en passant square, which lies behind a pawn that just moved two
+  if (!skipFenSpaces(c)) FEN_ERROR(en_passant);
+  if (*c == '-') ++c;
+  else {
+    char rank = (isWhitesMove()) ? '6' : '3';
+    if (*c < 'a' || *c > 'h' || c[1] != rank) FEN_ERROR(en_passant);
+    setEnPassantSquare(getIDX(rank - '1', *c - 'a'));
+    c += 2;
   }
-  ++i;
-#undef THROW_INVALID_FEN
+  if (*c != '\0' && !isFenSpace(*c)) FEN_ERROR(en_passant);
+
+  // parse the halfmove clock & fullmove number, if they are there
+  if (skipFenSpaces(c) && *c != '\0') {
+    if (!readFenNumber(c, halfmove_clock)) FEN_ERROR(halfmove_clock);
+    if (skipFenSpaces(c) && *c != '\0') {
+      if (!readFenNumber(c, fullmove_number)) FEN_ERROR(fullmove_number);
+      // some writers count from 0
+      if (!fullmove_number) fullmove_number = 1;
+      skipFenSpaces(c);
+    }
+  }
+  if (*c != '\0') FEN_ERROR(trailing_text);
+#undef FEN_ERROR
+  return FenError::none;
+}
+
+void Board::setUp(const char* fen) {
+  FenError error = parseFen(fen);
+  if (error != FenError::none) throw std::invalid_argument(std::string("Invalid FEN: ") + describe(error));
+}
+
+size_t Board::toFen(char* buf, size_t size) const noexcept {
+  // written to the stack first, as the length is only known at the end
+  char fen[max_fen_length];
+  char* out = fen;
+  for (int row = 7; row >= 0; --row) {
+    int empty = 0;
+    for (int col = 0; col < 8; ++col) {
+      Piece::Name p = mailbox[getIDX(row, col)];
+      if (Piece::isSquare(p)) {
+        ++empty;
+        continue;
+      }
+      if (empty) *out++ = static_cast<char>('0' + empty);
+      empty = 0;
+      *out++ = static_cast<char>(p);
+    }
+    if (empty) *out++ = static_cast<char>('0' + empty);
+    if (row) *out++ = '/';
+  }
+
+  *out++ = ' ';
+  *out++ = (isWhitesMove()) ? 'w' : 'b';
+  *out++ = ' ';
+  if (!(flags & castling_rights)) *out++ = '-';
+  if (flags & w_castle_kingside) *out++ = 'K';
+  if (flags & w_castle_queenside) *out++ = 'Q';
+  if (flags & b_castle_kingside) *out++ = 'k';
+  if (flags & b_castle_queenside) *out++ = 'q';
+  *out++ = ' ';
+  if (en_passant_square == -1) *out++ = '-';
+  else {
+    *out++ = getFile(en_passant_square);
+    *out++ = getRank(en_passant_square);
+  }
+  *out++ = ' ';
+  out = writeFenNumber(out, halfmove_clock);
+  *out++ = ' ';
+  out = writeFenNumber(out, fullmove_number);
+
+  size_t length = out - fen;
+  if (length + 1 > size) return 0;
+  std::memcpy(buf, fen, length);
+  buf[length] = '\0';
+  return length;
+}
+
+bool Board::pack(Packed::Position& packed) const noexcept {
+  bb occupied = bitboards[white] | bitboards[black];
+  if (countSetBits(occupied) > Packed::max_pieces) return false;
+  uint8_t* bytes = packed.bytes;
+  std::memset(bytes, 0, Packed::position_size);
+  for (int i = 0; i < 8; ++i) bytes[i] = static_cast<uint8_t>(occupied >> (8 * i));
+
+  // each piece's nibble goes in the slot counting the pieces below it
+  uint8_t* nibbles = bytes + 8;
+  for (size_t type = pawns; type < num_bitboards; ++type) {
+    bb pieces = bitboards[type];
+    while (pieces) {
+      int idx = popLS1B(&pieces);
+      int slot = countSetBits(occupied & (idxToBoard(idx) - 1));
+      unsigned nibble = static_cast<unsigned>(type - pawns) | (getBit(bitboards[white], idx) << 3);
+      nibbles[slot / 2] |= static_cast<uint8_t>(nibble << (4 * (slot & 1)));
+    }
+  }
+
+  bytes[24] = static_cast<uint8_t>(isWhitesMove() | ((flags & castling_rights) << 1));
+  bytes[25] = static_cast<uint8_t>(en_passant_square + 1);
+  bytes[26] = static_cast<uint8_t>(halfmove_clock);
+  bytes[27] = static_cast<uint8_t>(halfmove_clock >> 8);
+  bytes[28] = static_cast<uint8_t>(fullmove_number);
+  bytes[29] = static_cast<uint8_t>(fullmove_number >> 8);
+  return true;
+}
+
+bool Board::unpack(const Packed::Position& packed) noexcept {
+  clear();
+
+#define PACKED_ERROR do { clear(); return false; } while (false)
+  const uint8_t* bytes = packed.bytes;
+  bb occupied = 0;
+  for (int i = 0; i < 8; ++i) occupied |= static_cast<bb>(bytes[i]) << (8 * i);
+  int num_pieces = countSetBits(occupied);
+  if (num_pieces > Packed::max_pieces || (bytes[24] >> 5) || bytes[25] > 64 || bytes[30] || bytes[31])
+    PACKED_ERROR;
+
+  const uint8_t* nibbles = bytes + 8;
+  for (int slot = 0; slot < Packed::max_pieces; ++slot) {
+    unsigned nibble = (nibbles[slot / 2] >> (4 * (slot & 1))) & 0xf;
+    if (slot >= num_pieces) {
+      if (nibble) PACKED_ERROR;
+      continue;
+    }
+    unsigned type = nibble & 0x7;
+    if (type > 5) PACKED_ERROR;
+    placePiece(nibble >> 3, type, popLS1B(&occupied));
+  }
+
+  if (bytes[24] & 0x1) switchMoveSide();
+  setCastlingFlags(bytes[24] >> 1);
+  if (bytes[25]) {
+    int idx = bytes[25] - 1;
+    // as in a FEN, the square has to be behind a pawn that just moved two
+    if (getRankIDX(idx) != ((isWhitesMove()) ? Indexing::r6 : Indexing::r3)) PACKED_ERROR;
+    setEnPassantSquare(idx);
+  }
+  halfmove_clock = static_cast<uint16_t>(bytes[26] | (bytes[27] << 8));
+  fullmove_number = static_cast<uint16_t>(bytes[28] | (bytes[29] << 8));
+  if (!fullmove_number) PACKED_ERROR;
+#undef PACKED_ERROR
+  return true;
 }
 
 Piece::Name Board::rmPiece(int idx) noexcept {
   bb square = idxToBoard(idx);
   Piece::Name old_piece = getPiece(idx);
 
-  if (Piece::isWhite(old_piece)) {
+  bool is_white = Piece::isWhite(old_piece);
+  if (is_white) {
     bitboards[white] &= ~square;
   }
   else if (Piece::isBlack(old_piece)) {
@@ -83,26 +286,12 @@ Piece::Name Board::rmPiece(int idx) noexcept {
   }
   else return Piece::square;
 
-  switch (Piece::getType(old_piece)) {
-  case Piece::pawn:
-    bitboards[pawns] &= ~square;
-    break;
-  case Piece::rook:
-    bitboards[rooks] &= ~square;
-    break;
-  case Piece::knight:
-    bitboards[knights] &= ~square;
-    break;
-  case Piece::bishop:
-    bitboards[bishops] &= ~square;
-    break;
-  case Piece::queen:
-    bitboards[queens] &= ~square;
-    break;
-  case Piece::king:
-    bitboards[kings] &= ~square;
-    break;
-  }
+  IDX type_board = typeToBoard(Piece::getType(old_piece));
+  bitboards[type_board] &= ~square;
+  key ^= Zobrist::keys.piece_square[is_white][type_board - pawns][idx];
+  if (type_board == pawns) pawn_key ^= Zobrist::keys.piece_square[is_white][Zobrist::pawn][idx];
+  psqt -= PSQT::tables.piece_square[is_white][type_board - pawns][idx];
+  phase -= PSQT::phase_weight[type_board - pawns];
 
   mailbox[idx] = Piece::square;
 
@@ -112,7 +301,8 @@ Piece::Name Board::rmPiece(int idx) noexcept {
 void Board::dropPiece(Piece::Name p, int idx) noexcept {
   bb square = idxToBoard(idx);
 
-  if (Piece::isWhite(p)) {
+  bool is_white = Piece::isWhite(p);
+  if (is_white) {
     bitboards[white] |= square;
   }
   else if (Piece::isBlack(p)) {
@@ -120,205 +310,426 @@ void Board::dropPiece(Piece::Name p, int idx) noexcept {
   }
   else return;
 
-  switch (Piece::getType(p)) {
-  case Piece::pawn:
-    bitboards[pawns] |= square;
-    break;
-  case Piece::rook:
-    bitboards[rooks] |= square;
-    break;
-  case Piece::knight:
-    bitboards[knights] |= square;
-    break;
-  case Piece::bishop:
-    bitboards[bishops] |= square;
-    break;
-  case Piece::queen:
-    bitboards[queens] |= square;
-    break;
-  case Piece::king:
-    bitboards[kings] |= square;
-    break;
-  }
+  IDX type_board = typeToBoard(Piece::getType(p));
+  bitboards[type_board] |= square;
+  key ^= Zobrist::keys.piece_square[is_white][type_board - pawns][idx];
+  if (type_board == pawns) pawn_key ^= Zobrist::keys.piece_square[is_white][Zobrist::pawn][idx];
+  psqt += PSQT::tables.piece_square[is_white][type_board - pawns][idx];
+  phase += PSQT::phase_weight[type_board - pawns];
 
   mailbox[idx] = p;
 }
 
-vector<Move> Board::getAllMoves() const noexcept {
-  using namespace Movegen;
-  std::vector<Move> moves;
-  bb my_pieces = bitboards[isWhitesMove()];
-  bb enemy_pieces = bitboards[!isWhitesMove()];
-  bb empty_squares = ~my_pieces & ~enemy_pieces;
+void Board::placePiece(bool is_white, int type, int idx) noexcept {
+  bb square = idxToBoard(idx);
+  bitboards[is_white] |= square;
+  bitboards[pawns + type] |= square;
+  key ^= Zobrist::keys.piece_square[is_white][type][idx];
+  // branch free, as pawns & pieces come in no predictable order
+  pawn_key ^= Zobrist::keys.piece_square[is_white][Zobrist::pawn][idx] & (0 - static_cast<Zobrist::Key>(type == Zobrist::pawn));
+  psqt += PSQT::tables.piece_square[is_white][type][idx];
+  phase += PSQT::phase_weight[type];
+  mailbox[idx] = pieces_by_type[is_white][type];
+}
 
-  bb bishoplike = bitboards[bishops] | bitboards[queens];
-  bb rooklike = bitboards[rooks] | bitboards[queens];
+Zobrist::Key Board::computeKey() const noexcept {
+  Zobrist::Key k = 0;
+  for (int idx = 0; idx < 64; ++idx) {
+    Piece::Name p = getPiece(idx);
+    if (Piece::isSquare(p)) continue;
+    k ^= Zobrist::keys.piece_square[Piece::isWhite(p)][typeToBoard(Piece::getType(p)) - pawns][idx];
+  }
+  k ^= Zobrist::keys.castling[flags & castling_rights];
+  if (en_passant_square != -1)
+    k ^= Zobrist::keys.en_passant_file[Indexing::getFileIDX(en_passant_square)];
+  if (isWhitesMove()) k ^= Zobrist::keys.white_to_move;
+  return k;
+}
 
-  bb my_pawns = bitboards[pawns] & my_pieces;
-  bb my_knights = bitboards[knights] & my_pieces;
-  bb my_bishops = bitboards[bishops] & my_pieces;
-  bb my_rooks = bitboards[rooks] & my_pieces;
-  bb my_queens = bitboards[queens] & my_pieces;
-  bb my_king = bitboards[kings] & my_pieces;
+Zobrist::Key Board::computePawnKey() const noexcept {
+  Zobrist::Key k = 0;
+  for (int is_white = 0; is_white < 2; ++is_white) {
+    bb pawn_board = bitboards[pawns] & bitboards[is_white];
+    while (pawn_board) k ^= Zobrist::keys.piece_square[is_white][Zobrist::pawn][popLS1B(&pawn_board)];
+  }
+  return k;
+}
 
+PSQT::Score Board::computePsqt() const noexcept {
+  PSQT::Score score{ 0, 0 };
+  for (int idx = 0; idx < 64; ++idx) {
+    Piece::Name p = getPiece(idx);
+    if (Piece::isSquare(p)) continue;
+    score += PSQT::tables.piece_square[Piece::isWhite(p)][typeToBoard(Piece::getType(p)) - pawns][idx];
+  }
+  return score;
+}
+
+bool Board::isInCheck() const noexcept {
+  bool whites_move = isWhitesMove();
+  bb my_king = bitboards[kings] & bitboards[whites_move];
+  if (!my_king) return false;
+  int king_idx = indexOfLS1B(my_king);
+  bb enemy_pieces = bitboards[!whites_move];
+  bb occupied = enemy_pieces | bitboards[whites_move];
+  return (knight_attacks[king_idx] & bitboards[knights] & enemy_pieces)
+    || (pawn_attacks[whites_move][king_idx] & bitboards[pawns] & enemy_pieces)
+    || (bishopAttacks(king_idx, occupied) & (bitboards[bishops] | bitboards[queens]) & enemy_pieces)
+    || (rookAttacks(king_idx, occupied) & (bitboards[rooks] | bitboards[queens]) & enemy_pieces);
+}
+
+Movegen::ChecksAndPins Board::findChecksAndPins(int king_idx) const noexcept {
+  if (king_idx == -1) return { 0, 0 };
+  bool whites_move = isWhitesMove();
+  bb my_pieces = bitboards[whites_move];
+  bb enemy_pieces = bitboards[!whites_move];
+  bb occupied = my_pieces | enemy_pieces;
+  bb enemy_bishoplike = (bitboards[bishops] | bitboards[queens]) & enemy_pieces;
+  bb enemy_rooklike = (bitboards[rooks] | bitboards[queens]) & enemy_pieces;
+
+  bb checkers = (knight_attacks[king_idx] & bitboards[knights] & enemy_pieces)
+    | (pawn_attacks[whites_move][king_idx] & bitboards[pawns] & enemy_pieces)
+    | (bishopAttacks(king_idx, occupied) & enemy_bishoplike)
+    | (rookAttacks(king_idx, occupied) & enemy_rooklike);
+
+  // sliders that would hit the king if only my pieces were lifted off the
+  // board pin a piece when exactly one of mine stands in the way
+  bb pinned = 0;
+  bb snipers = (bishopAttacks(king_idx, enemy_pieces) & enemy_bishoplike)
+    | (rookAttacks(king_idx, enemy_pieces) & enemy_rooklike);
+  while (snipers) {
+    bb blockers = squaresBetween(king_idx, popLS1B(&snipers)) & occupied;
+    if (blockers && !(blockers & (blockers - 1)) && (blockers & my_pieces)) pinned |= blockers;
+  }
+  return { checkers, pinned };
+}
+
+bool Board::isLegalEnPassant(int from, int king_idx, bb checkers) const noexcept {
+  if (king_idx == -1) return true;
+  bool whites_move = isWhitesMove();
+  bb enemy_pieces = bitboards[!whites_move];
+  bb captured = idxToBoard(en_passant_square + ((whites_move) ? Indexing::south : Indexing::north));
+  bb occupied_after = ((enemy_pieces | bitboards[whites_move]) ^ idxToBoard(from) ^ captured)
+    | idxToBoard(en_passant_square);
+  bb still_checking = (checkers & ~captured & (bitboards[pawns] | bitboards[knights]))
+    | (bishopAttacks(king_idx, occupied_after) & (bitboards[bishops] | bitboards[queens]) & enemy_pieces)
+    | (rookAttacks(king_idx, occupied_after) & (bitboards[rooks] | bitboards[queens]) & enemy_pieces);
+  return !still_checking;
+}
+
+bb Board::findKingThreats() const noexcept {
+  using namespace Movegen;
+  bool whites_move = isWhitesMove();
+  bb enemy_pieces = bitboards[!whites_move];
+  bb my_king = bitboards[kings] & bitboards[whites_move];
+  bb empty_squares = ~(enemy_pieces | bitboards[whites_move]);
   bb enemy_pawns = bitboards[pawns] & enemy_pieces;
   bb enemy_knights = bitboards[knights] & enemy_pieces;
-  bb enemy_bishoplike = bishoplike & enemy_pieces;
-  bb enemy_rooklike = rooklike & enemy_pieces;
+  bb enemy_bishoplike = (bitboards[bishops] | bitboards[queens]) & enemy_pieces;
+  bb enemy_rooklike = (bitboards[rooks] | bitboards[queens]) & enemy_pieces;
   bb enemy_king = bitboards[kings] & enemy_pieces;
-
-  bb en_passant_pawn = 0, en_passant_target = 0;
-  if (en_passant_square != -1) {
-    en_passant_target = idxToBoard(en_passant_square);
-    en_passant_pawn = (isWhitesMove())
-      ? idxToBoard(en_passant_square + Indexing::south)
-      : idxToBoard(en_passant_square + Indexing::north);
-  }
-
-  bb valid_move_targets = (isWhitesMove())
-    ? legalMoveTargetsWhite(my_king, empty_squares, enemy_pawns
-      , enemy_knights, enemy_bishoplike, enemy_rooklike)
-    : legalMoveTargetsBlack(my_king, empty_squares, enemy_pawns
-      , enemy_knights, enemy_bishoplike, enemy_rooklike);
-  bb under_threat = ((isWhitesMove())
+  return (whites_move)
     ? genAllThreatsBlack(enemy_pawns, enemy_knights, enemy_bishoplike
       , enemy_rooklike, enemy_king, empty_squares | my_king)
     : genAllThreatsWhite(enemy_pawns, enemy_knights, enemy_bishoplike
-      , enemy_rooklike, enemy_king, empty_squares | my_king));
-
-  bb valid_cap_targets = valid_move_targets & enemy_pieces;
-  bb valid_quiet_targets = valid_move_targets & empty_squares;
-
-  bb pinned_nw = findPinnedRailNW(my_king, enemy_pieces, enemy_bishoplike);
-  bb pinned_ne = findPinnedRailNE(my_king, enemy_pieces, enemy_bishoplike);
-  bb pinned_sw = findPinnedRailSW(my_king, enemy_pieces, enemy_bishoplike);
-  bb pinned_se = findPinnedRailSE(my_king, enemy_pieces, enemy_bishoplike);
-  bb pinned_n = findPinnedRailN(my_king, enemy_pieces, enemy_rooklike);
-  bb pinned_s = findPinnedRailS(my_king, enemy_pieces, enemy_rooklike);
-  bb pinned_e = findPinnedRailE(my_king, enemy_pieces, enemy_rooklike);
-  bb pinned_w = findPinnedRailW(my_king, enemy_pieces, enemy_rooklike);
-  bb pinned_e_pwn_cap = findPinnedRailE(my_king, enemy_pieces & ~en_passant_pawn, enemy_rooklike);
-  bb pinned_w_pwn_cap = findPinnedRailW(my_king, enemy_pieces & ~en_passant_pawn, enemy_rooklike);
-
-  pinned_nw = (pinned_nw & enemy_pieces) ? 0 : ((countSetBits(pinned_nw & my_pieces) == 1) ? pinned_nw : 0);
-  pinned_ne = (pinned_ne & enemy_pieces) ? 0 : ((countSetBits(pinned_ne & my_pieces) == 1) ? pinned_ne : 0);
-  pinned_sw = (pinned_sw & enemy_pieces) ? 0 : ((countSetBits(pinned_sw & my_pieces) == 1) ? pinned_sw : 0);
-  pinned_se = (pinned_se & enemy_pieces) ? 0 : ((countSetBits(pinned_se & my_pieces) == 1) ? pinned_se : 0);
-  pinned_n = (pinned_n & enemy_pieces) ? 0 : ((countSetBits(pinned_n & my_pieces) == 1) ? pinned_n : 0);
-  pinned_s = (pinned_s & enemy_pieces) ? 0 : ((countSetBits(pinned_s & my_pieces) == 1) ? pinned_s : 0);
-
-  pinned_e = (pinned_e & enemy_pieces) ? 0 : ((countSetBits(pinned_e & my_pieces) == 1) ? pinned_e : 0);
-  pinned_w = (pinned_w & enemy_pieces) ? 0 : ((countSetBits(pinned_w & my_pieces) == 1) ? pinned_w : 0);
-
-  bb pinned_bishop_rails = pinned_nw | pinned_ne | pinned_sw | pinned_se;
-  bb pinned_bishop_cap_targets = valid_cap_targets & pinned_bishop_rails;
-  bb pinned_bishop_quiet_targets = valid_quiet_targets & pinned_bishop_rails;
-  bb pinned_rook_rails = pinned_n | pinned_s | pinned_e | pinned_w;
-  bb pinned_rook_cap_targets = valid_cap_targets & pinned_rook_rails;
-  bb pinned_rook_quiet_targets = valid_quiet_targets & pinned_rook_rails;
-
-  bb pinned_pwn_cap_rail = pinned_e_pwn_cap | pinned_w_pwn_cap | pinned_n | pinned_s;
-
-  bb not_pinned = ~(pinned_bishop_rails | pinned_rook_rails);
-  bb not_pinned_pwn_cap = ~pinned_pwn_cap_rail;
+      , enemy_rooklike, enemy_king, empty_squares | my_king);
+}
+
+template <class MoveSink>
+void Board::getMoves(MoveSink& moves, GenType type, bb movable) const noexcept {
+  using namespace Movegen;
+  bool whites_move = isWhitesMove();
+  bb my_pieces = bitboards[whites_move];
+  bb enemy_pieces = bitboards[!whites_move];
+  bb occupied = my_pieces | enemy_pieces;
+  bb empty_squares = ~occupied;
+
+  bb my_king = bitboards[kings] & my_pieces;
+  bb my_movers = my_pieces & movable;
+  bb my_pawns = bitboards[pawns] & my_movers;
+  bb my_knights = bitboards[knights] & my_movers;
+  bb my_bishops = bitboards[bishops] & my_movers;
+  bb my_rooks = bitboards[rooks] & my_movers;
+  bb my_queens = bitboards[queens] & my_movers;
+  // enemy pawns decide whether a double push allows en passant
+  bb enemy_pawns = bitboards[pawns] & enemy_pieces;
+
+  int king_idx = (my_king) ? indexOfLS1B(my_king) : -1;
+  Movegen::ChecksAndPins checks_and_pins = findChecksAndPins(king_idx);
+  bb checkers = checks_and_pins.checks, pinned = checks_and_pins.pins;
+  bb check_mask = checkMask(king_idx, checkers);
+
+  bb not_pinned = ~pinned;
+  bb cap_targets = (type & gen_captures) ? enemy_pieces & check_mask : 0;
+  bb quiet_targets = (type & gen_quiets) ? empty_squares & check_mask : 0;
+  bb pin_cap_targets = (type & gen_captures) ? enemy_pieces : 0;
+  bb pin_quiet_targets = (type & gen_quiets) ? empty_squares : 0;
 
   // capture moves
-  if (isWhitesMove()) {
-    if (valid_cap_targets & en_passant_pawn) {
-      genPawnCapsN(my_pawns & not_pinned_pwn_cap, valid_cap_targets | en_passant_target, moves);
-      genPawnCapsN(my_pawns & pinned_bishop_rails, pinned_bishop_cap_targets | en_passant_target, moves);
+  if (whites_move) genPawnCapsN(my_pawns & not_pinned, cap_targets, moves);
+  else genPawnCapsS(my_pawns & not_pinned, cap_targets, moves);
+  genKnightCaps(my_knights & not_pinned, cap_targets, moves);
+  genBishopCaps(my_bishops & not_pinned, empty_squares, cap_targets, moves);
+  genRookCaps(my_rooks & not_pinned, empty_squares, cap_targets, moves);
+  genQueenCaps(my_queens & not_pinned, empty_squares, cap_targets, moves);
+
+  if (en_passant_square != -1 && (type & gen_captures)) {
+    bb capturers = pawn_attacks[!whites_move][en_passant_square] & my_pawns;
+    while (capturers) {
+      int from = popLS1B(&capturers);
+      if (isLegalEnPassant(from, king_idx, checkers)) moves.push_back(Move(from, en_passant_square));
+    }
+  }
+
+  if (quiet_targets) {
+    genKnightMoves(my_knights & not_pinned, quiet_targets, moves);
+    genBishopMoves(my_bishops & not_pinned, empty_squares, quiet_targets, moves);
+    genRookMoves(my_rooks & not_pinned, empty_squares, quiet_targets, moves);
+    genQueenMoves(my_queens & not_pinned, empty_squares, quiet_targets, moves);
+    if (whites_move) genPawnPushesN(my_pawns & not_pinned, empty_squares, quiet_targets, enemy_pawns, moves);
+    else genPawnPushesS(my_pawns & not_pinned, empty_squares, quiet_targets, enemy_pawns, moves);
+  }
+
+  // a pinned piece can only slide along its pin, & can't also block or
+  // capture a checker, so it only moves when not in check
+  // (a pinned knight can never move)
+  bb pinned_movers = (checkers) ? 0 : pinned & movable & ~my_knights;
+  while (pinned_movers) {
+    int from = popLS1B(&pinned_movers);
+    bb piece = idxToBoard(from);
+    bb rail = lineThrough(king_idx, from);
+    if (piece & my_pawns) {
+      if (whites_move) {
+        genPawnCapsN(piece, pin_cap_targets & rail, moves);
+        genPawnPushesN(piece, empty_squares, pin_quiet_targets & rail, enemy_pawns, moves);
+      }
+      else {
+        genPawnCapsS(piece, pin_cap_targets & rail, moves);
+        genPawnPushesS(piece, empty_squares, pin_quiet_targets & rail, enemy_pawns, moves);
+      }
     }
     else {
-      genPawnCapsN(my_pawns & not_pinned, valid_cap_targets, moves);
-      genPawnCapsN(my_pawns & pinned_bishop_rails, pinned_bishop_cap_targets, moves);
+      if (piece & (my_bishops | my_queens)) {
+        genBishopCaps(piece, empty_squares, pin_cap_targets & rail, moves);
+        genBishopMoves(piece, empty_squares, pin_quiet_targets & rail, moves);
+      }
+      if (piece & (my_rooks | my_queens)) {
+        genRookCaps(piece, empty_squares, pin_cap_targets & rail, moves);
+        genRookMoves(piece, empty_squares, pin_quiet_targets & rail, moves);
+      }
     }
   }
-  else {
-    if (valid_cap_targets & en_passant_pawn) {
-      genPawnCapsS(my_pawns & not_pinned_pwn_cap, valid_cap_targets | en_passant_target, moves);
-      genPawnCapsS(my_pawns & pinned_bishop_rails, pinned_bishop_cap_targets | en_passant_target, moves);
+
+  if (!(my_king & movable)) return;
+  bb under_threat = findKingThreats();
+  // with no empty squares the king can only capture, & with no enemy pieces only step
+  bool quiets = type & gen_quiets;
+  genKingMoves(my_king, (quiets) ? empty_squares : 0, ~under_threat
+    , (type & gen_captures) ? enemy_pieces : 0
+    , quiets && canCastleQueenside(whites_move), quiets && canCastleKingside(whites_move), moves);
+}
+template void Board::getMoves(std::vector<Move>&, GenType, bb) const noexcept;
+template void Board::getMoves(MoveList&, GenType, bb) const noexcept;
+
+int Board::countLegalMoves() const noexcept {
+  bool whites_move = isWhitesMove();
+  bb my_pieces = bitboards[whites_move];
+  bb enemy_pieces = bitboards[!whites_move];
+  bb occupied = my_pieces | enemy_pieces;
+  bb empty_squares = ~occupied;
+  bb my_pawns = bitboards[pawns] & my_pieces;
+  bb my_knights = bitboards[knights] & my_pieces;
+  bb my_bishoplike = (bitboards[bishops] | bitboards[queens]) & my_pieces;
+  bb my_rooklike = (bitboards[rooks] | bitboards[queens]) & my_pieces;
+  bb my_king = bitboards[kings] & my_pieces;
+
+  int king_idx = (my_king) ? indexOfLS1B(my_king) : -1;
+  Movegen::ChecksAndPins checks_and_pins = findChecksAndPins(king_idx);
+  bb checkers = checks_and_pins.checks, pinned = checks_and_pins.pins;
+  bb check_mask = checkMask(king_idx, checkers);
+  bb not_pinned = ~pinned;
+
+  // pawns are counted set-wise, with each move onto the last rank
+  // standing for its four promotions
+  bb last_rank = (whites_move) ? Bitboards::r8 : Bitboards::r1;
+  bb double_rank = (whites_move) ? Bitboards::r4 : Bitboards::r5;
+  auto countPawnMoves = [&](bb from_pawns, bb targets) {
+    bb singles, doubles, caps_w, caps_e;
+    if (whites_move) {
+      singles = shiftN(from_pawns) & empty_squares;
+      doubles = shiftN(singles) & double_rank & empty_squares;
+      caps_w = shiftNW(from_pawns);
+      caps_e = shiftNE(from_pawns);
     }
     else {
-      genPawnCapsS(my_pawns & not_pinned, valid_cap_targets, moves);
-      genPawnCapsS(my_pawns & pinned_bishop_rails, pinned_bishop_cap_targets, moves);
+      singles = shiftS(from_pawns) & empty_squares;
+      doubles = shiftS(singles) & double_rank & empty_squares;
+      caps_w = shiftSW(from_pawns);
+      caps_e = shiftSE(from_pawns);
     }
+    singles &= targets;
+    caps_w &= enemy_pieces & targets;
+    caps_e &= enemy_pieces & targets;
+    return countSetBits(doubles & targets)
+      + countSetBits(singles & ~last_rank) + 4 * countSetBits(singles & last_rank)
+      + countSetBits(caps_w & ~last_rank) + 4 * countSetBits(caps_w & last_rank)
+      + countSetBits(caps_e & ~last_rank) + 4 * countSetBits(caps_e & last_rank);
+  };
+
+  bb targets = ~my_pieces & check_mask;
+  int count = countPawnMoves(my_pawns & not_pinned, check_mask);
+  for (bb knights_left = my_knights & not_pinned; knights_left; ) {
+    count += countSetBits(knight_attacks[popLS1B(&knights_left)] & targets);
   }
-  genKnightCaps(my_knights & not_pinned, valid_cap_targets, moves);
-  genBishopCaps(my_bishops & not_pinned, empty_squares, valid_cap_targets, moves);
-  genBishopCaps(my_bishops & pinned_bishop_rails, pinned_bishop_rails, pinned_bishop_cap_targets, moves);
-  genRookCaps(my_rooks & not_pinned, empty_squares, valid_cap_targets, moves);
-  genRookCaps(my_rooks & pinned_rook_rails, pinned_rook_rails, pinned_rook_cap_targets, moves);
-  genQueenCaps(my_queens & not_pinned, empty_squares, valid_cap_targets, moves);
-  genQueenCaps(my_queens & pinned_bishop_rails, pinned_bishop_rails, pinned_bishop_cap_targets, moves);
-  genQueenCaps(my_queens & pinned_rook_rails, pinned_rook_rails, pinned_rook_cap_targets, moves);
-
-  genKnightMoves(my_knights & not_pinned, valid_quiet_targets, moves);
-  genBishopMoves(my_bishops & not_pinned, valid_quiet_targets, moves);
-  genBishopMoves(my_bishops & pinned_bishop_rails, pinned_bishop_quiet_targets, moves);
-  genRookMoves(my_rooks & not_pinned, valid_quiet_targets, moves);
-  genRookMoves(my_rooks & pinned_rook_rails, pinned_rook_quiet_targets, moves);
-  genQueenMoves(my_queens & not_pinned, valid_quiet_targets, moves);
-  genQueenMoves(my_queens & pinned_bishop_rails, pinned_bishop_quiet_targets, moves);
-  genQueenMoves(my_queens & pinned_rook_rails, pinned_rook_quiet_targets, moves);
-
-  if (isWhitesMove()) {
-    genPawnPushesN(my_pawns & not_pinned, valid_quiet_targets, enemy_pawns, moves);
-    genPawnPushesN(my_pawns & pinned_rook_rails, pinned_rook_quiet_targets, enemy_pawns, moves);
-    genKingMoves(my_king, empty_squares, ~under_threat, enemy_pieces
-      , flags & w_castle_queenside, flags & w_castle_kingside, moves);
+  for (bb sliders = my_bishoplike & not_pinned; sliders; ) {
+    count += countSetBits(bishopAttacks(popLS1B(&sliders), occupied) & targets);
   }
-  else {
-    genPawnPushesS(my_pawns & not_pinned, valid_quiet_targets, enemy_pawns, moves);
-    genPawnPushesS(my_pawns & pinned_bishop_rails, pinned_rook_quiet_targets, enemy_pawns, moves);
-    genKingMoves(my_king, empty_squares, ~under_threat, enemy_pieces
-      , flags & b_castle_queenside, flags & b_castle_kingside, moves);
+  for (bb sliders = my_rooklike & not_pinned; sliders; ) {
+    count += countSetBits(rookAttacks(popLS1B(&sliders), occupied) & targets);
+  }
+
+  // as in getMoves(), pinned pieces only move along their pin when not in check
+  bb pinned_movers = (checkers) ? 0 : pinned & ~my_knights;
+  while (pinned_movers) {
+    int from = popLS1B(&pinned_movers);
+    bb piece = idxToBoard(from);
+    bb rail = lineThrough(king_idx, from);
+    if (piece & my_pawns) count += countPawnMoves(piece, rail);
+    else {
+      if (piece & my_bishoplike) count += countSetBits(bishopAttacks(from, occupied) & ~my_pieces & rail);
+      if (piece & my_rooklike) count += countSetBits(rookAttacks(from, occupied) & ~my_pieces & rail);
+    }
+  }
+
+  if (en_passant_square != -1) {
+    bb capturers = pawn_attacks[!whites_move][en_passant_square] & my_pawns;
+    while (capturers) count += isLegalEnPassant(popLS1B(&capturers), king_idx, checkers);
   }
-  return moves;
+
+  if (king_idx == -1) return count;
+  bb under_threat = findKingThreats();
+  count += countSetBits(king_attacks[king_idx] & ~my_pieces & ~under_threat);
+  if (!checkers) {
+    // the same conditions genKingMoves() checks for castling
+    bb safe_empty = empty_squares & ~under_threat;
+    int rank = (whites_move) ? Indexing::r1 : Indexing::r8;
+    auto isSafeEmpty = [&](int file) { return (safe_empty & idxToBoard(file + rank)) != 0; };
+    if (canCastleKingside(whites_move) && isSafeEmpty(Indexing::f) && isSafeEmpty(Indexing::g)) ++count;
+    if (canCastleQueenside(whites_move) && isSafeEmpty(Indexing::d) && isSafeEmpty(Indexing::c)
+      && (empty_squares & idxToBoard(Indexing::b + rank))) ++count;
+  }
+  return count;
 }
 
-Piece::Name Board::executeMove(Move move) noexcept {
+bool Board::isLegal(Move move) const noexcept {
+  int from = move.getFromSquare();
+  if (!(bitboards[isWhitesMove()] & idxToBoard(from))) return false;
+  MoveList moves;
+  getMoves(moves, gen_all, idxToBoard(from));
+  for (Move legal : moves) {
+    if (legal == move) return true;
+  }
+  return false;
+}
+
+const std::array<uint8_t, 64> Board::castle_rights_mask = [] {
+  std::array<uint8_t, 64> mask{};
+  mask.fill(0xff);
+  mask[Indexing::a + Indexing::r1] = static_cast<uint8_t>(~w_castle_queenside);
+  mask[Indexing::e + Indexing::r1] = static_cast<uint8_t>(~(w_castle_queenside | w_castle_kingside));
+  mask[Indexing::h + Indexing::r1] = static_cast<uint8_t>(~w_castle_kingside);
+  mask[Indexing::a + Indexing::r8] = static_cast<uint8_t>(~b_castle_queenside);
+  mask[Indexing::e + Indexing::r8] = static_cast<uint8_t>(~(b_castle_queenside | b_castle_kingside));
+  mask[Indexing::h + Indexing::r8] = static_cast<uint8_t>(~b_castle_kingside);
+  return mask;
+}();
+
+Board::Undo Board::makeMove(Move move) noexcept {
   using Indexing::north, Indexing::south;
   int from = move.getFromSquare(), to = move.getToSquare();
   Move::Special special = move.getSpecial();
+  Undo undo{ Piece::square, flags, static_cast<int8_t>(en_passant_square), halfmove_clock, key };
 
   Piece::Name piece = rmPiece(from);
+  bool is_pawn = Piece::isPawn(piece);
 
   Piece::Name on_dest = rmPiece(to);
-  if (to == en_passant_square) {
-    switch (piece) {
-    case Piece::white_pawn: on_dest = rmPiece(to + south);
-      break;
-    case Piece::black_pawn: on_dest = rmPiece(to + north);
-      break;
-    default: break;
-    }
+  if (to == en_passant_square && is_pawn) {
+    on_dest = rmPiece(to + ((isWhitesMove()) ? south : north));
   }
-  en_passant_square = -1;
+  setEnPassantSquare(-1);
 
   switch (special) {
   case Move::promo: piece = Piece::makePiece(move.getPromoPieceType(), isWhitesMove());
     break;
-  case Move::en_passant: en_passant_square = from + (isWhitesMove()) ? north : south;
+  case Move::en_passant: setEnPassantSquare(from + ((isWhitesMove()) ? north : south));
     break;
-  case Move::castling:
-    Indexing::RankIDX from_rank = (isWhitesMove()) ? Indexing::RankIDX::r1 : Indexing::RankIDX::r8;
+  case Move::castling: {
     int rook_from, rook_to;
-    if (to > from) {
-      rook_from = from_rank + Indexing::FileIDX::h;
-      rook_to = from_rank + Indexing::FileIDX::f;
-    }
-    else {
-      rook_from = from_rank + Indexing::FileIDX::a;
-      rook_to = from_rank + Indexing::FileIDX::d;
+    getCastlingRookSquares(from, to, rook_from, rook_to);
+    dropPiece(rmPiece(rook_from), rook_to);
+    break;
+  }
+  default: break;
+  }
+
+  dropPiece(piece, to);
+  setCastlingFlags(flags & castle_rights_mask[from] & castle_rights_mask[to]);
+  halfmove_clock = (is_pawn || !Piece::isSquare(on_dest)) ? 0 : halfmove_clock + 1;
+  if (isBlacksMove()) ++fullmove_number;
+  switchMoveSide();
+
+  undo.captured = on_dest;
+  return undo;
+}
+
+void Board::unmakeMove(Move move, Undo undo) noexcept {
+  using Indexing::north, Indexing::south;
+  int from = move.getFromSquare(), to = move.getToSquare();
+  Move::Special special = move.getSpecial();
+
+  // restoring the flags also gives the move back to the side that made it
+  flags = undo.flags;
+  en_passant_square = undo.en_passant_square;
+  halfmove_clock = undo.halfmove_clock;
+  if (isBlacksMove()) --fullmove_number;
+
+  Piece::Name piece = rmPiece(to);
+  if (special == Move::promo) piece = Piece::makePiece(Piece::pawn, isWhitesMove());
+  dropPiece(piece, from);
+
+  if (!Piece::isSquare(undo.captured)) {
+    int captured_from = to;
+    if (to == en_passant_square && Piece::isPawn(piece)) {
+      captured_from += (isWhitesMove()) ? south : north;
     }
-    pushPiece(rmPiece(rook_from), rook_to);
+    dropPiece(undo.captured, captured_from);
+  }
+
+  if (special == Move::castling) {
+    int rook_from, rook_to;
+    getCastlingRookSquares(from, to, rook_from, rook_to);
+    dropPiece(rmPiece(rook_to), rook_from);
   }
 
-  
-  
-  pushPiece(piece, to);
+  // the piece moves above churned the key, so restore it last
+  key = undo.key;
+}
+
+Board::Undo Board::makeNullMove() noexcept {
+  Undo undo{ Piece::square, flags, static_cast<int8_t>(en_passant_square), halfmove_clock, key };
+  setEnPassantSquare(-1);
+  // nothing before a pass can repeat a position after it
+  halfmove_clock = 0;
   switchMoveSide();
-  return on_dest;
+  return undo;
+}
+
+void Board::unmakeNullMove(Undo undo) noexcept {
+  flags = undo.flags;
+  en_passant_square = undo.en_passant_square;
+  halfmove_clock = undo.halfmove_clock;
+  key = undo.key;
 }
 
 std::string Board::getBuffer() const noexcept {
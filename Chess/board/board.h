@@ -10,21 +10,33 @@
 #include "bitboards/bitboards.h"
 #include "indexing.h"
 #include "movegen/movegen.h"
+#include "packed.h"
 #include "pieces.h"
+#include "psqt.h"
+#include "zobrist.h"
 
 class Board {
 public:
   inline Board() noexcept : bitboards(), mailbox(), flags()
-    , en_passant_square() { clear(); }
-  inline Board(Board& to_copy) noexcept : bitboards(to_copy.bitboards)
+    , en_passant_square(), halfmove_clock(), fullmove_number(), key(), pawn_key(), psqt(), phase() { clear(); }
+  inline Board(const Board& to_copy) noexcept : bitboards(to_copy.bitboards)
     , mailbox(to_copy.mailbox), flags(to_copy.flags)
-    , en_passant_square(to_copy.en_passant_square) {}
+    , en_passant_square(to_copy.en_passant_square)
+    , halfmove_clock(to_copy.halfmove_clock), fullmove_number(to_copy.fullmove_number), key(to_copy.key)
+    , pawn_key(to_copy.pawn_key), psqt(to_copy.psqt), phase(to_copy.phase) {}
 
   inline Board& operator=(const Board& rhs) noexcept {
     bitboards = rhs.bitboards;
     mailbox = rhs.mailbox;
     flags = rhs.flags;
     en_passant_square = rhs.en_passant_square;
+    halfmove_clock = rhs.halfmove_clock;
+    fullmove_number = rhs.fullmove_number;
+    key = rhs.key;
+    pawn_key = rhs.pawn_key;
+    psqt = rhs.psqt;
+    phase = rhs.phase;
+    return *this;
   }
 
   inline void clear() noexcept {
@@ -32,21 +44,101 @@ public:
     mailbox.fill(Piece::square);
     flags = 0;
     en_passant_square = -1;
+    halfmove_clock = 0;
+    fullmove_number = 1;
+    key = 0;
+    pawn_key = 0;
+    psqt = { 0, 0 };
+    phase = 0;
   }
 
-  // set up the Board based on a position defined by Forsyth-Edwards Notation
+  // which part of a FEN parseFen() couldn't read
+  enum class FenError : uint8_t {
+    none, placement, side_to_move, castling, en_passant,
+    halfmove_clock, fullmove_number, trailing_text
+  };
+  static const char* describe(FenError error) noexcept;
+
+  // set up the Board based on a position defined by Forsyth-Edwards Notation,
+  // in a single pass that drops each piece straight onto the empty board
+  // the halfmove clock & fullmove number may be left off (as in EPD), in
+  // which case they start at 0 & 1; on an error the Board is left cleared
+  // https://en.wikipedia.org/wiki/Forsyth%E2%80%93Edwards_Notation
+  FenError parseFen(const char* fen) noexcept;
+  // parseFen(), throwing std::invalid_argument on a bad FEN
   // the default value for fen represents the starting position
   void setUp(const char* fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
   inline void setUp(std::string& fen) { setUp(fen.c_str()); }
 
+  // the longest FEN toFen() can write, including the terminating '\0'
+  constexpr static inline size_t max_fen_length = 96;
+  // writes the position as a '\0' terminated FEN into buf, without allocating
+  // returns its length, or 0 (writing nothing) if it needs more than size bytes
+  size_t toFen(char* buf, size_t size) const noexcept;
+  inline std::string toFen() const {
+    char buf[max_fen_length];
+    return std::string(buf, toFen(buf, sizeof(buf)));
+  }
+
+  // encodes the position into 32 bytes (see packed.h), straight from the bitboards
+  // returns false if there are more than Packed::max_pieces pieces
+  bool pack(Packed::Position& packed) const noexcept;
+  // sets up the position encoded by pack()
+  // returns false (leaving the Board cleared) if packed isn't a valid encoding
+  bool unpack(const Packed::Position& packed) noexcept;
+
   inline bool isWhitesMove() const noexcept { return flags & white_to_move; }
   inline bool isBlacksMove() const noexcept { return !isWhitesMove(); }
-  inline void switchMoveSide() noexcept { flags ^= white_to_move; }
-  inline void makeWhitesMove() noexcept { flags |= white_to_move; }
-  inline void makeBlacksMove() noexcept { flags &= ~white_to_move; }
+  inline void switchMoveSide() noexcept {
+    flags ^= white_to_move;
+    key ^= Zobrist::keys.white_to_move;
+  }
+  inline void makeWhitesMove() noexcept { if (isBlacksMove()) switchMoveSide(); }
+  inline void makeBlacksMove() noexcept { if (isWhitesMove()) switchMoveSide(); }
+
+  // the Zobrist key of the position, kept up to date as the board changes
+  inline Zobrist::Key getKey() const noexcept { return key; }
+  // recomputes the Zobrist key from scratch (for setup & debugging)
+  Zobrist::Key computeKey() const noexcept;
+  // the Zobrist key of the pawns alone, for caching pawn structure
+  // (only pawn moves, captures of pawns & promotions change it)
+  inline Zobrist::Key getPawnKey() const noexcept { return pawn_key; }
+  Zobrist::Key computePawnKey() const noexcept;
+
+  // the sum of the piece-square scores of every piece, kept up to date
+  // as the board changes (from white's point of view)
+  inline PSQT::Score getPsqt() const noexcept { return psqt; }
+  // how much non-pawn material is left, from 0 (bare kings & pawns) upwards
+  // (PSQT::max_phase for a full set; more only after extra promotions)
+  inline int getPhase() const noexcept { return phase; }
+  // recomputes the piece-square score from scratch (for debugging)
+  PSQT::Score computePsqt() const noexcept;
+
+  // whether the side has kept the right to castle on each wing
+  inline bool canCastleKingside(bool white) const noexcept {
+    return flags & ((white) ? w_castle_kingside : b_castle_kingside);
+  }
+  inline bool canCastleQueenside(bool white) const noexcept {
+    return flags & ((white) ? w_castle_queenside : b_castle_queenside);
+  }
+  // the square a pawn can capture onto en passant, or -1 if there is none
+  inline int getEnPassantSquare() const noexcept { return en_passant_square; }
+  // the number of plies since the last capture or pawn move
+  inline int getHalfmoveClock() const noexcept { return halfmove_clock; }
+  // the number of the current move, starting at 1 & going up after black's
+  inline int getFullmoveNumber() const noexcept { return fullmove_number; }
 
   // Read which piece is on the desired square on the board
-  Piece::Name getPiece(int idx) noexcept { return mailbox[idx]; }
+  Piece::Name getPiece(int idx) const noexcept { return mailbox[idx]; }
+  // the squares holding every piece of type p & the same color
+  // ! p must not be Piece::square
+  inline Bitboards::bb getPieces(Piece::Name p) const noexcept {
+    return bitboards[typeToBoard(Piece::getType(p))] & bitboards[Piece::isWhite(p)];
+  }
+  // the squares holding every piece of one color
+  inline Bitboards::bb getPieces(bool white) const noexcept { return bitboards[white]; }
+  // whether the side to move is in check
+  bool isInCheck() const noexcept;
   // Removes any piece from the board square specified
   // Returns the piece removed
   Piece::Name rmPiece(int idx) noexcept;
@@ -62,9 +154,69 @@ public:
     return old_piece;
   }
 
-  std::vector<Move> getAllMoves() const noexcept;
+  // which legal moves getMoves() generates
+  // captures include en passant & capturing promotions, quiets everything else
+  enum GenType : uint8_t {
+    gen_captures = 0x1, gen_quiets = 0x2, gen_all = gen_captures | gen_quiets
+  };
+  // appends the legal moves of the given type, made by the pieces in movable
+  // (compiled for std::vector<Move> and MoveList)
+  template <class MoveSink>
+  void getMoves(MoveSink& moves, GenType type, Bitboards::bb movable = ~0ULL) const noexcept;
+
+  // appends every legal move to moves
+  template <class MoveSink>
+  inline void getAllMoves(MoveSink& moves) const noexcept { getMoves(moves, gen_all); }
+  inline std::vector<Move> getAllMoves() const noexcept {
+    std::vector<Move> moves;
+    getAllMoves(moves);
+    return moves;
+  }
+  template <class MoveSink>
+  inline void getCaptures(MoveSink& moves) const noexcept { getMoves(moves, gen_captures); }
+  template <class MoveSink>
+  inline void getQuiets(MoveSink& moves) const noexcept { getMoves(moves, gen_quiets); }
+
+  // the number of legal moves, counted from the target bitboards without
+  // building any Moves (promotions count as four)
+  int countLegalMoves() const noexcept;
 
-  Piece::Name executeMove(Move move) noexcept;
+  // whether move is legal here (for moves from tables, which may be stale)
+  // only the piece on the move's from square has its moves generated
+  bool isLegal(Move move) const noexcept;
+  // whether move takes a piece, including en passant
+  inline bool isCapture(Move move) const noexcept {
+    int to = move.getToSquare();
+    return !Piece::isSquare(mailbox[to])
+      || (to == en_passant_square && Piece::isPawn(mailbox[move.getFromSquare()]));
+  }
+
+  // everything makeMove() overwrites that can't be recovered from the Move,
+  // so that unmakeMove() can restore the position exactly
+  struct Undo {
+    Piece::Name captured;
+    uint8_t flags;
+    int8_t en_passant_square;
+    uint16_t halfmove_clock;
+    Zobrist::Key key;
+  };
+
+  // Plays a legal move on the board
+  // Returns what unmakeMove() needs to take it back
+  Undo makeMove(Move move) noexcept;
+  // Takes back the last move played by makeMove()
+  // ! move and undo must be exactly what was passed to & returned from makeMove()
+  void unmakeMove(Move move, Undo undo) noexcept;
+  // Passes the turn to the other side without moving anything
+  // (for null move pruning); the halfmove clock restarts, so the
+  // search doesn't mistake positions on either side of it for repetitions
+  // ! must not be played while in check
+  Undo makeNullMove() noexcept;
+  // Takes back the pass made by makeNullMove()
+  void unmakeNullMove(Undo undo) noexcept;
+  // Plays a legal move on the board
+  // Returns the piece captured
+  inline Piece::Name executeMove(Move move) noexcept { return makeMove(move).captured; }
 
   std::string getBuffer() const noexcept;
   std::string getBuffer(std::vector<Move>& moves) const noexcept;
@@ -87,6 +239,18 @@ private:
     rooks = 5, queens = 6, kings = 7,
   };
 
+  // converts a piece Type to the index of its bitboard
+  constexpr static inline IDX typeToBoard(Piece::Type type) noexcept {
+    switch (type) {
+    case Piece::pawn: return pawns;
+    case Piece::knight: return knights;
+    case Piece::bishop: return bishops;
+    case Piece::rook: return rooks;
+    case Piece::queen: return queens;
+    default: return kings;
+    }
+  }
+
   std::array<Piece::Name, 64> mailbox;
 
   uint8_t flags;
@@ -94,10 +258,74 @@ private:
     w_castle_queenside = 0x01, w_castle_kingside = 0x02,
     b_castle_queenside = 0x04, b_castle_kingside = 0x08,
 
+    castling_rights = 0x0f,
+
     white_to_move = 0x10,
   };
 
   int en_passant_square;
+  uint16_t halfmove_clock;
+  uint16_t fullmove_number;
+
+  Zobrist::Key key;
+  Zobrist::Key pawn_key;
+  PSQT::Score psqt;
+  int phase;
+
+  // drops the piece of one color & type index (pawn = 0 ... king = 5) onto an
+  // empty square, for setting up positions: with the type already known, it
+  // skips dropPiece()'s branching on the piece's name
+  void placePiece(bool is_white, int type, int idx) noexcept;
+
+  // changes the castling flags, keeping the key in sync
+  inline void setCastlingFlags(uint8_t castling) noexcept {
+    key ^= Zobrist::keys.castling[flags & castling_rights]
+      ^ Zobrist::keys.castling[castling & castling_rights];
+    flags = (flags & ~castling_rights) | (castling & castling_rights);
+  }
+  // changes the en passant square (-1 for none), keeping the key in sync
+  inline void setEnPassantSquare(int idx) noexcept {
+    if (en_passant_square != -1)
+      key ^= Zobrist::keys.en_passant_file[Indexing::getFileIDX(en_passant_square)];
+    if (idx != -1)
+      key ^= Zobrist::keys.en_passant_file[Indexing::getFileIDX(idx)];
+    en_passant_square = idx;
+  }
+
+  // the castling rights that survive a move touching each square
+  // (moving or capturing the king or a rook loses the matching rights)
+  static const std::array<uint8_t, 64> castle_rights_mask;
+
+  // the enemy pieces giving check to the king on king_idx,
+  // & my pieces pinned to it (both empty if there is no king)
+  Movegen::ChecksAndPins findChecksAndPins(int king_idx) const noexcept;
+  // where a piece other than the king has to land to deal with check
+  // (everywhere if not in check, nowhere if in double check)
+  inline static Bitboards::bb checkMask(int king_idx, Bitboards::bb checkers) noexcept {
+    if (!checkers) return ~0ULL;
+    if (checkers & (checkers - 1)) return 0;
+    return checkers | Bitboards::squaresBetween(king_idx, Binary::indexOfLS1B(checkers));
+  }
+  // whether the pawn on from can take en passant without leaving its king
+  // in check; the capture can uncover an attack along the rank of both pawns,
+  // so it is checked by looking from the king with the position after it
+  bool isLegalEnPassant(int from, int king_idx, Bitboards::bb checkers) const noexcept;
+  // every square the enemy attacks, with my king lifted off the board
+  // (the king can't hide from a slider by stepping along its line)
+  Bitboards::bb findKingThreats() const noexcept;
+
+  // finds where the rook moves from & to when the king castles from -> to
+  inline void getCastlingRookSquares(int from, int to, int& rook_from, int& rook_to) const noexcept {
+    Indexing::RankIDX from_rank = (isWhitesMove()) ? Indexing::RankIDX::r1 : Indexing::RankIDX::r8;
+    if (to > from) {
+      rook_from = from_rank + Indexing::FileIDX::h;
+      rook_to = from_rank + Indexing::FileIDX::f;
+    }
+    else {
+      rook_from = from_rank + Indexing::FileIDX::a;
+      rook_to = from_rank + Indexing::FileIDX::d;
+    }
+  }
 };
 
 #endif
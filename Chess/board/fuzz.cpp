@@ -0,0 +1,228 @@
+// differential fuzzer for the move generator
+//
+// plays random games from a set of start positions & at every position
+// compares Board::getAllMoves() against the slow Reference::getAllMoves(),
+// checks that getCaptures() & getQuiets() split the same moves between them
+// & that countLegalMoves() agrees on how many there are,
+// & checks that makeMove()/unmakeMove() keep the position, key & piece-square
+// score intact & that toFen()/parseFen() & pack()/unpack() round trip
+// every position
+//
+// usage:
+//   fuzzMovegen [games] [seed]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "reference.h"
+
+using std::cout, std::endl;
+
+namespace {
+  const char* const start_positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    // the perft suite
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    // en passant that would expose the king along the rank
+    "8/8/8/KPp4r/8/8/8/7k w - c6 0 2",
+    "8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1",
+    // en passant capturing a checking pawn
+    "8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1",
+    // promotions with & without captures
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+    // castling through & into attacks
+    "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1",
+    "r3k2r/8/8/8/8/8/8/1R2K2R b Kkq - 0 1",
+    "4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1",
+    "1r2k3/8/8/8/8/8/8/R3K2R w KQ - 0 1",
+    // pins on every line
+    "4k3/4r3/8/b6b/8/2B1Q3/1q1NK1Nr/8 w - - 0 1",
+  };
+
+  // xorshift64*, so a run can be repeated from its seed
+  uint64_t rand64(uint64_t& state) noexcept {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545f4914f6cdd1d;
+  }
+
+  void sortMoves(std::vector<Move>& moves) {
+    std::sort(moves.begin(), moves.end(), [](Move lhs, Move rhs) {
+      return lhs.getBits() < rhs.getBits();
+    });
+  }
+
+  void printMoves(const char* label, const std::vector<Move>& moves) {
+    cout << "  " << label << ":";
+    for (const Move& move : moves) cout << " " << move.toUCI() << "(" << move.getBits() << ")";
+    cout << endl;
+  }
+
+  // prints how to reproduce a position: the start FEN & the moves played
+  void printHistory(const char* fen, const std::vector<Move>& history) {
+    cout << "  start: " << fen << endl << "  moves:";
+    for (const Move& move : history) cout << " " << move.toUCI();
+    cout << endl;
+  }
+
+  // compares both generators at the current position
+  // returns false (after printing the difference) if they disagree
+  bool checkPosition(const Board& board, const char* fen, const std::vector<Move>& history) {
+    std::vector<Move> fast, slow;
+    board.getAllMoves(fast);
+    Reference::getAllMoves(board, slow);
+    sortMoves(fast);
+    sortMoves(slow);
+
+    // the staged generators must split the same set between them
+    std::vector<Move> staged;
+    board.getCaptures(staged);
+    size_t num_captures = staged.size();
+    board.getQuiets(staged);
+    bool split_ok = std::all_of(staged.begin(), staged.begin() + num_captures
+      , [&](Move move) { return board.isCapture(move); })
+      && std::none_of(staged.begin() + num_captures, staged.end()
+      , [&](Move move) { return board.isCapture(move); });
+    sortMoves(staged);
+    if (!split_ok || staged != fast) {
+      cout << "[FAIL] captures & quiets don't split the legal moves" << endl;
+      printHistory(fen, history);
+      return false;
+    }
+    if (board.countLegalMoves() != static_cast<int>(fast.size())) {
+      cout << "[FAIL] countLegalMoves() gave " << board.countLegalMoves()
+        << ", expected " << fast.size() << endl;
+      printHistory(fen, history);
+      return false;
+    }
+    if (fast == slow) return true;
+
+    std::vector<Move> missing, extra;
+    std::set_difference(slow.begin(), slow.end(), fast.begin(), fast.end(), std::back_inserter(missing)
+      , [](Move lhs, Move rhs) { return lhs.getBits() < rhs.getBits(); });
+    std::set_difference(fast.begin(), fast.end(), slow.begin(), slow.end(), std::back_inserter(extra)
+      , [](Move lhs, Move rhs) { return lhs.getBits() < rhs.getBits(); });
+    cout << "[FAIL] move generators disagree" << endl;
+    printHistory(fen, history);
+    printMoves("missing", missing);
+    printMoves("extra", extra);
+    return false;
+  }
+
+  // writing the position as FEN & reading it back must give the same
+  // position, key & counters
+  bool checkFen(const Board& board, const char* fen, const std::vector<Move>& history) {
+    char written[Board::max_fen_length];
+    size_t length = board.toFen(written, sizeof(written));
+    Board copy;
+    Board::FenError error = copy.parseFen(written);
+    if (!length || error != Board::FenError::none) {
+      cout << "[FAIL] couldn't read back \"" << written << "\": " << Board::describe(error) << endl;
+      printHistory(fen, history);
+      return false;
+    }
+    if (copy.getBuffer() != board.getBuffer() || copy.getKey() != board.getKey()
+      || copy.getPawnKey() != board.getPawnKey() || copy.getPsqt() != board.getPsqt()
+      || copy.getPhase() != board.getPhase() || copy.getHalfmoveClock() != board.getHalfmoveClock()
+      || copy.getFullmoveNumber() != board.getFullmoveNumber() || copy.toFen() != written) {
+      cout << "[FAIL] \"" << written << "\" read back as a different position" << endl;
+      printHistory(fen, history);
+      return false;
+    }
+    return true;
+  }
+
+  // packing the position & unpacking it must give the same position,
+  // key & counters
+  bool checkPacked(const Board& board, const char* fen, const std::vector<Move>& history) {
+    Packed::Position packed;
+    Board copy;
+    if (!board.pack(packed) || !copy.unpack(packed)) {
+      cout << "[FAIL] couldn't pack & unpack " << board.toFen() << endl;
+      printHistory(fen, history);
+      return false;
+    }
+    if (copy.toFen() != board.toFen() || copy.getKey() != board.getKey()
+      || copy.getPawnKey() != board.getPawnKey() || copy.getPsqt() != board.getPsqt()
+      || copy.getPhase() != board.getPhase()) {
+      cout << "[FAIL] " << board.toFen() << " unpacked as " << copy.toFen() << endl;
+      printHistory(fen, history);
+      return false;
+    }
+    return true;
+  }
+
+  // plays one random game, checking every position along the way
+  bool playGame(const char* fen, uint64_t& seed, int max_plies) {
+    Board board;
+    board.setUp(fen);
+    std::vector<Move> history;
+    if (board.toFen() != fen) {
+      cout << "[FAIL] " << fen << " written back as " << board.toFen() << endl;
+      return false;
+    }
+    for (int ply = 0; ply < max_plies; ++ply) {
+      if (!checkPosition(board, fen, history) || !checkFen(board, fen, history)
+        || !checkPacked(board, fen, history)) return false;
+
+      // walk every move & back again, checking nothing is left behind
+      std::vector<Move> moves = board.getAllMoves();
+      if (moves.empty()) break;
+      std::string before = board.getBuffer();
+      int fullmove_number = board.getFullmoveNumber();
+      for (Move move : moves) {
+        Board::Undo undo = board.makeMove(move);
+        bool key_ok = board.getKey() == board.computeKey() && board.getPsqt() == board.computePsqt()
+          && board.getPawnKey() == board.computePawnKey();
+        board.unmakeMove(move, undo);
+        if (!key_ok || board.getKey() != undo.key || board.getBuffer() != before
+          || board.getPsqt() != board.computePsqt() || board.getPawnKey() != board.computePawnKey()
+          || board.getFullmoveNumber() != fullmove_number) {
+          cout << "[FAIL] make/unmake of " << move.toUCI() << " corrupted the board" << endl;
+          printHistory(fen, history);
+          return false;
+        }
+      }
+      // passing must leave the same pieces & be taken back exactly
+      if (!board.isInCheck()) {
+        Board::Undo undo = board.makeNullMove();
+        bool key_ok = board.getKey() == board.computeKey() && board.getBuffer() == before;
+        board.unmakeNullMove(undo);
+        if (!key_ok || board.getKey() != undo.key || board.getKey() != board.computeKey()) {
+          cout << "[FAIL] make/unmake of a null move corrupted the board" << endl;
+          printHistory(fen, history);
+          return false;
+        }
+      }
+
+      Move move = moves[rand64(seed) % moves.size()];
+      board.makeMove(move);
+      history.push_back(move);
+    }
+    return true;
+  }
+}
+
+int main(int argc, char** argv) {
+  int games = (argc > 1) ? std::atoi(argv[1]) : 1000;
+  uint64_t seed = (argc > 2) ? std::strtoull(argv[2], nullptr, 0) : 0x9e3779b97f4a7c15;
+  if (!seed) seed = 1;
+  const int num_starts = sizeof(start_positions) / sizeof(start_positions[0]);
+
+  cout << "Fuzzing " << games << " games (seed " << seed << ")..." << endl;
+  for (int game = 0; game < games; ++game) {
+    if (!playGame(start_positions[game % num_starts], seed, 200)) return 1;
+  }
+  cout << "[PASS]" << endl;
+  return 0;
+}
@@ -22,6 +22,8 @@ public:
     queen = 0x3 << 12,
   };
 
+  // leaves the move uninitialized, so arrays of Moves are free to create
+  Move() noexcept = default;
   Move(int from, int to) : move(from | (to << 6)) {}
   Move(int from, int to, Special special) : move(from | (to << 6) | special) {}
   Move(int from, int to, Promo promo, Special special)
@@ -40,14 +42,27 @@ public:
     move = (move & ~to_square) | ((to << 6) & to_square);
   }
 
-  inline bool operator==(Move& rhs) const noexcept { return move == rhs.move; }
+  inline bool operator==(const Move& rhs) const noexcept { return move == rhs.move; }
+  inline bool operator!=(const Move& rhs) const noexcept { return move != rhs.move; }
+
+  // a move that is never legal (a1 to a1), for empty slots in tables
+  inline static Move none() noexcept { return fromBits(0); }
+  inline bool isNone() const noexcept { return move == 0; }
+
+  // the raw 16-bit encoding, for packing Moves into tables
+  inline uint16_t getBits() const noexcept { return move; }
+  inline static Move fromBits(uint16_t bits) noexcept {
+    Move m;
+    m.move = bits;
+    return m;
+  }
 
   // get which piece a pawn is being promoted to
   inline Promo getPromoType() const noexcept {
     return static_cast<Promo>(move & promo_type);
   }
   inline Piece::Type getPromoPieceType() const noexcept {
-    switch (getSpecial()) {
+    switch (getPromoType()) {
     case knight: return Piece::knight;
     case bishop: return Piece::bishop;
     case rook: return Piece::rook;
@@ -81,6 +96,20 @@ public:
     }
   }
 
+  // the move in long algebraic notation, as used by UCI (e.g. "e2e4", "e7e8q")
+  std::string toUCI() const noexcept {
+    std::string st = Indexing::idxToString(getFromSquare()) + Indexing::idxToString(getToSquare());
+    if (getSpecial() == promo) {
+      switch (getPromoType()) {
+      case knight: st += 'n'; break;
+      case bishop: st += 'b'; break;
+      case rook: st += 'r'; break;
+      case queen: st += 'q'; break;
+      }
+    }
+    return st;
+  }
+
   friend std::ostream& operator<<(std::ostream& os, Move& move) {
     return os << move.toString();
   }
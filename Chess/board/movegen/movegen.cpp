@@ -5,18 +5,18 @@ using namespace Bitboards;
 
 using std::vector;
 
-void Movegen::genPawnPushesN(bb pawns, bb empty_squares, bb enemy_pawns, vector<Move>& out_to) noexcept {
+template <class MoveSink>
+void Movegen::genPawnPushesN(bb pawns, bb empty_squares, bb targets, bb enemy_pawns, MoveSink& out_to) noexcept {
   using namespace Piece;
   if (!pawns) return;
   bb singles = shiftN(pawns) & empty_squares; // single-square pawn moves
-  bb doubles = shiftN(singles) & r4 & empty_squares;
+  bb doubles = shiftN(singles) & r4 & empty_squares & targets;
   bb en_passant_avail = (shiftW(enemy_pawns) | shiftE(enemy_pawns)) & doubles;
-  bb dest_square = 0;
-  for (; singles; singles &= ~dest_square) {
-    int to = indexOfMS1B(singles);
-    dest_square = idxToBoard(to);
+  singles &= targets;
+  while (singles) {
+    int to = popLS1B(&singles);
     int from = to + Indexing::south;
-    if (dest_square & r8) {
+    if (idxToBoard(to) & r8) {
       // potential pawn promotion
       out_to.push_back(Move(from, to, Move::queen, Move::promo));
       out_to.push_back(Move(from, to, Move::rook, Move::promo));
@@ -25,30 +25,28 @@ void Movegen::genPawnPushesN(bb pawns, bb empty_squares, bb enemy_pawns, vector<
     }
     else out_to.push_back(Move(from, to));
   }
-  dest_square = 0;
-  for (; doubles; doubles &= ~dest_square) {
-    int to = indexOfMS1B(doubles);
-    dest_square = idxToBoard(to);
+  while (doubles) {
+    int to = popLS1B(&doubles);
     int from = to + 2 * Indexing::south;
-    if (dest_square & en_passant_avail) {
+    if (idxToBoard(to) & en_passant_avail) {
       // pawn could be captured en passant
       out_to.push_back(Move(from, to, Move::en_passant));
     }
     else out_to.push_back(Move(from, to));
   }
 }
-void Movegen::genPawnPushesS(bb pawns, bb empty_squares, bb enemy_pawns, vector<Move>& out_to) noexcept {
+template <class MoveSink>
+void Movegen::genPawnPushesS(bb pawns, bb empty_squares, bb targets, bb enemy_pawns, MoveSink& out_to) noexcept {
   using namespace Piece;
   if (!pawns) return;
   bb singles = shiftS(pawns) & empty_squares; // single-square pawn moves
-  bb doubles = shiftS(singles) & r5 & empty_squares;
+  bb doubles = shiftS(singles) & r5 & empty_squares & targets;
   bb en_passant_avail = (shiftW(enemy_pawns) | shiftE(enemy_pawns)) & doubles;
-  bb dest_square  = 0;
-  for (; singles; singles &= ~dest_square) {
-    int to = indexOfMS1B(singles);
-    dest_square = idxToBoard(to);
+  singles &= targets;
+  while (singles) {
+    int to = popLS1B(&singles);
     int from = to + Indexing::north;
-    if (dest_square & r8) {
+    if (idxToBoard(to) & r1) {
       // potential pawn promotion
       out_to.push_back(Move(from, to, Move::queen, Move::promo));
       out_to.push_back(Move(from, to, Move::rook, Move::promo));
@@ -57,12 +55,10 @@ void Movegen::genPawnPushesS(bb pawns, bb empty_squares, bb enemy_pawns, vector<
     }
     else out_to.push_back(Move(from, to));
   }
-  dest_square = 0;
-  for (; doubles; doubles &= ~dest_square) {
-    int to = indexOfMS1B(doubles);
-    dest_square = idxToBoard(to);
+  while (doubles) {
+    int to = popLS1B(&doubles);
     int from = to + 2 * Indexing::north;
-    if (dest_square & en_passant_avail) {
+    if (idxToBoard(to) & en_passant_avail) {
       // pawn could be captured en passant
       out_to.push_back(Move(from, to, Move::en_passant));
     }
@@ -70,7 +66,8 @@ void Movegen::genPawnPushesS(bb pawns, bb empty_squares, bb enemy_pawns, vector<
   }
 }
 
-void Movegen::genPawnCapsN(bb from_pawns, bb targets, vector<Move>& out_to) noexcept {
+template <class MoveSink>
+void Movegen::genPawnCapsN(bb from_pawns, bb targets, MoveSink& out_to) noexcept {
   using Indexing::n_west, Indexing::n_east, Indexing::s_west, Indexing::s_east;
   using namespace Piece;
   
@@ -78,11 +75,10 @@ void Movegen::genPawnCapsN(bb from_pawns, bb targets, vector<Move>& out_to) noex
   // the north/south shift will never overflow, so no masking is needed
   // therefore, we use the shift() function from Binary to avoid it
   bb caps = shiftNW(from_pawns) & targets;
-  for (bb dest_square = 0; caps; caps &= ~dest_square) {
-    int to = indexOfMS1B(caps);
+  while (caps) {
+    int to = popLS1B(&caps);
     int from = to + s_east;
-    dest_square = idxToBoard(to);
-    if (dest_square & r8) {
+    if (idxToBoard(to) & r8) {
       // potential pawn promotion
       out_to.push_back(Move(from, to, Move::queen, Move::promo));
       out_to.push_back(Move(from, to, Move::rook, Move::promo));
@@ -92,11 +88,10 @@ void Movegen::genPawnCapsN(bb from_pawns, bb targets, vector<Move>& out_to) noex
     else out_to.push_back(Move(from, to));
   }
   caps = shiftNE(from_pawns) & targets;
-  for (bb dest_square = 0; caps; caps &= ~dest_square) {
-    int to = indexOfMS1B(caps);
+  while (caps) {
+    int to = popLS1B(&caps);
     int from = to + s_west;
-    dest_square = idxToBoard(to);
-    if (dest_square & r8) {
+    if (idxToBoard(to) & r8) {
       // potential pawn promotion
       out_to.push_back(Move(from, to, Move::queen, Move::promo));
       out_to.push_back(Move(from, to, Move::rook, Move::promo));
@@ -106,7 +101,8 @@ void Movegen::genPawnCapsN(bb from_pawns, bb targets, vector<Move>& out_to) noex
     else out_to.push_back(Move(from, to));
   }
 }
-void Movegen::genPawnCapsS(bb from_pawns, bb targets, vector<Move>& out_to) noexcept {
+template <class MoveSink>
+void Movegen::genPawnCapsS(bb from_pawns, bb targets, MoveSink& out_to) noexcept {
   using Indexing::n_west, Indexing::n_east, Indexing::s_west, Indexing::s_east;
   using namespace Piece;
 
@@ -114,11 +110,10 @@ void Movegen::genPawnCapsS(bb from_pawns, bb targets, vector<Move>& out_to) noex
   // the north/south shift will never overflow, so no masking is needed
   // therefore, we use the shift() function from Binary to avoid it
   bb caps = shiftSW(from_pawns) & targets;
-  for (bb dest_square = 0; caps; caps &= ~dest_square) {
-    int to = indexOfMS1B(caps);
+  while (caps) {
+    int to = popLS1B(&caps);
     int from = to + n_east;
-    dest_square = idxToBoard(to);
-    if (dest_square & r8) {
+    if (idxToBoard(to) & r1) {
       // potential pawn promotion
       out_to.push_back(Move(from, to, Move::queen, Move::promo));
       out_to.push_back(Move(from, to, Move::rook, Move::promo));
@@ -128,11 +123,10 @@ void Movegen::genPawnCapsS(bb from_pawns, bb targets, vector<Move>& out_to) noex
     else out_to.push_back(Move(from, to));
   }
   caps = shiftSE(from_pawns) & targets;
-  for (bb dest_square = 0; caps; caps &= ~dest_square) {
-    int to = indexOfMS1B(caps);
+  while (caps) {
+    int to = popLS1B(&caps);
     int from = to + n_west;
-    dest_square = idxToBoard(to);
-    if (dest_square & r8) {
+    if (idxToBoard(to) & r1) {
       // potential pawn promotion
       out_to.push_back(Move(from, to, Move::queen, Move::promo));
       out_to.push_back(Move(from, to, Move::rook, Move::promo));
@@ -143,116 +137,111 @@ void Movegen::genPawnCapsS(bb from_pawns, bb targets, vector<Move>& out_to) noex
   }
 }
 
-void Movegen::genKnightMoves(bb knights, bb empty_squares, vector<Move>& out_to) noexcept {
-  for (bb from_square = 0; knights; knights &= ~from_square) {
-    int from = indexOfMS1B(knights), to;
-    from_square = idxToBoard(from);
+template <class MoveSink>
+void Movegen::genKnightMoves(bb knights, bb empty_squares, MoveSink& out_to) noexcept {
+  while (knights) {
+    int from = popLS1B(&knights), to;
 
-    bb slides = genKnightThreats(from_square) & empty_squares;
+    bb slides = knight_attacks[from] & empty_squares;
     while (slides) {
-      to = indexOfMS1B(slides);
+      to = popLS1B(&slides);
       out_to.push_back(Move(from, to));
-      slides &= ~idxToBoard(to);
     }
   }
 }
-void Movegen::genKnightCaps(bb knights, bb enemy_pieces, vector<Move>& out_to) noexcept {
-  for (bb from_square = 0; knights; knights &= ~from_square) {
-    int from = indexOfMS1B(knights), to;
-    from_square = idxToBoard(from);
+template <class MoveSink>
+void Movegen::genKnightCaps(bb knights, bb enemy_pieces, MoveSink& out_to) noexcept {
+  while (knights) {
+    int from = popLS1B(&knights), to;
 
-    bb caps = genKnightThreats(from_square) & enemy_pieces;
+    bb caps = knight_attacks[from] & enemy_pieces;
     while (caps) {
-      to = indexOfMS1B(caps);
+      to = popLS1B(&caps);
       out_to.push_back(Move(from, to));
-      caps &= ~idxToBoard(to);
     }
   }
 }
 
-void Movegen::genBishopMoves(bb bishops, bb empty_squares, vector<Move>& out_to) noexcept {
-  for (bb from_square = 0; bishops; bishops &= ~from_square) {
-    int from = indexOfMS1B(bishops), to;
-    from_square = idxToBoard(from);
+template <class MoveSink>
+void Movegen::genBishopMoves(bb bishops, bb empty_squares, bb targets, MoveSink& out_to) noexcept {
+  while (bishops) {
+    int from = popLS1B(&bishops), to;
 
-    bb slides = genBishopThreats(from_square, empty_squares) & empty_squares;
+    bb slides = bishopAttacks(from, ~empty_squares) & empty_squares & targets;
     while (slides) {
-      to = indexOfMS1B(slides);
+      to = popLS1B(&slides);
       out_to.push_back(Move(from, to));
-      slides &= ~idxToBoard(to);
     }
   }
 }
-void Movegen::genBishopCaps(bb bishops, bb empty_squares, bb enemy_pieces, vector<Move>& out_to) noexcept {
-  for (bb from_square = 0; bishops; bishops &= ~from_square) {
-    int from = indexOfMS1B(bishops), to;
-    from_square = idxToBoard(from);
+template <class MoveSink>
+void Movegen::genBishopCaps(bb bishops, bb empty_squares, bb enemy_pieces, MoveSink& out_to) noexcept {
+  while (bishops) {
+    int from = popLS1B(&bishops), to;
 
-    bb caps = genBishopThreats(from_square, empty_squares) & enemy_pieces;
+    bb caps = bishopAttacks(from, ~empty_squares) & enemy_pieces;
     while (caps) {
-      to = indexOfMS1B(caps);
+      to = popLS1B(&caps);
       out_to.push_back(Move(from, to));
-      caps &= ~idxToBoard(to);
     }
   }
 }
 
-void Movegen::genRookMoves(bb rooks, bb empty_squares, vector<Move>& out_to) noexcept {
-  for (bb from_square = 0; rooks; rooks &= ~from_square) {
-    int from = indexOfMS1B(rooks), to;
-    from_square = idxToBoard(from);
-    bb slides = genRookThreats(from_square, empty_squares) & empty_squares;
+template <class MoveSink>
+void Movegen::genRookMoves(bb rooks, bb empty_squares, bb targets, MoveSink& out_to) noexcept {
+  while (rooks) {
+    int from = popLS1B(&rooks), to;
+    bb slides = rookAttacks(from, ~empty_squares) & empty_squares & targets;
     while (slides) {
-      to = indexOfMS1B(slides);
+      to = popLS1B(&slides);
       out_to.push_back(Move(from, to));
-      slides &= ~idxToBoard(to);
     }
   }
 }
-void Movegen::genRookCaps(bb rooks, bb empty_squares, bb enemy_pieces, vector<Move>& out_to) noexcept {
-  for (bb from_square = 0; rooks; rooks &= ~from_square) {
-    int from = indexOfMS1B(rooks), to;
-    from_square = idxToBoard(from);
+template <class MoveSink>
+void Movegen::genRookCaps(bb rooks, bb empty_squares, bb enemy_pieces, MoveSink& out_to) noexcept {
+  while (rooks) {
+    int from = popLS1B(&rooks), to;
 
-    bb caps = genRookThreats(from_square, empty_squares) & enemy_pieces;
+    bb caps = rookAttacks(from, ~empty_squares) & enemy_pieces;
     while (caps) {
-      to = indexOfMS1B(caps);
+      to = popLS1B(&caps);
       out_to.push_back(Move(from, to));
-      caps &= ~idxToBoard(to);
     }
   }
 }
 
+template <class MoveSink>
 void Movegen::genKingMoves(Bitboards::bb king, Bitboards::bb empty_squares
   , Bitboards::bb not_threatened, Bitboards::bb enemy_pieces, bool castle_queenside
-  , bool castle_kingside, vector<Move>& out_to) noexcept {
+  , bool castle_kingside, MoveSink& out_to) noexcept {
+  if (!king) return;
   int from = indexOfMS1B(king), to;
-  bb threats = genKingThreats(king);
+  bb threats = king_attacks[from];
   bb moves_board = threats & not_threatened;
   bb empty_not_threatened = empty_squares & not_threatened;
   king &= not_threatened;
+  // the king only has to pass through safe squares, but queenside the rook
+  // also crosses the b-file, so that square has to be empty too
   bb castle_board = empty_not_threatened & (
-    ((castle_queenside) ? shiftW(shiftW(king) & empty_not_threatened) : 0)
+    ((castle_queenside) ? shiftW(shiftW(king) & empty_not_threatened) & shiftE(empty_squares) : 0)
     | ((castle_kingside) ? shiftE(shiftE(king) & empty_not_threatened) : 0));
 
   bb caps = moves_board & enemy_pieces;
   while (caps) {
-    to = indexOfMS1B(caps);
+    to = popLS1B(&caps);
     out_to.push_back(Move(from, to));
-    caps &= ~(idxToBoard(to));
   }
 
-  bb slides = moves_board & ~enemy_pieces;
+  bb slides = moves_board & empty_squares;
   while (slides) {
-    to = indexOfMS1B(slides);
+    to = popLS1B(&slides);
     out_to.push_back(Move(from, to));
-    slides &= ~(idxToBoard(to));
   }
 
   while (castle_board) {
-    to = indexOfMS1B(castle_board);
+    to = popLS1B(&castle_board);
     out_to.push_back(Move(from, to, Move::castling));
-    castle_board &= ~idxToBoard(to);
   }
 }
 
@@ -293,7 +282,7 @@ bb Movegen::legalMoveTargetsWhite(bb king, bb empty_squares, bb enemy_pawns
   bb e = shiftE(obstructedFillE(king, empty_squares));
   bb w = shiftW(obstructedFillW(king, empty_squares));
   bb knight = genKnightThreats(king);
-  bb pawn = genPawnThreatsN(enemy_pawns);
+  bb pawn = shiftN(shiftW(king) | shiftE(king));
   bb checking_pieces = ((nw | ne | sw | se) & enemy_bishoplike)
     | ((n | s | e | w) & enemy_rooklike)
     | (knight & enemy_knights) | (pawn & enemy_pawns);
@@ -347,3 +336,22 @@ bb Movegen::legalMoveTargetsBlack(bb king, bb empty_squares, bb enemy_pawns
   default: return 0;
   }
 }
+
+// compile the generators for each MoveSink in use
+#define INSTANTIATE_MOVEGEN(MoveSink) \
+  template void Movegen::genPawnPushesN(bb, bb, bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genPawnPushesS(bb, bb, bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genPawnCapsN(bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genPawnCapsS(bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genKnightMoves(bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genKnightCaps(bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genBishopMoves(bb, bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genBishopCaps(bb, bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genRookMoves(bb, bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genRookCaps(bb, bb, bb, MoveSink&) noexcept; \
+  template void Movegen::genKingMoves(bb, bb, bb, bb, bool, bool, MoveSink&) noexcept;
+
+INSTANTIATE_MOVEGEN(vector<Move>)
+INSTANTIATE_MOVEGEN(MoveList)
+
+#undef INSTANTIATE_MOVEGEN
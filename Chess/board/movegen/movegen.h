@@ -4,8 +4,14 @@
 #include <vector>
 
 #include "../bitboards/bitboards.h"
+#include "../bitboards/magic.h"
 #include "../indexing.h"
 #include "move.h"
+#include "movelist.h"
+
+// every function that generates Moves appends them to out_to, which can be
+// any MoveSink with a push_back(Move) method
+// (the ones compiled in are std::vector<Move> and MoveList)
 
 namespace Movegen {
   struct ChecksAndPins {
@@ -15,66 +21,108 @@ namespace Movegen {
 
   // generates quiet pawn moves (for white)
   // first one is the double-pushes, then single-pushes
+  // only pushes landing on targets are added
   // ! adds at most 16 Moves to out_to
+  template <class MoveSink>
   void genPawnPushesN(Bitboards::bb pawns, Bitboards::bb empty_squares
-    , Bitboards::bb enemy_pawns, std::vector<Move>& out_to) noexcept;
+    , Bitboards::bb targets, Bitboards::bb enemy_pawns, MoveSink& out_to) noexcept;
+  template <class MoveSink>
+  inline void genPawnPushesN(Bitboards::bb pawns, Bitboards::bb empty_squares
+    , Bitboards::bb enemy_pawns, MoveSink& out_to) noexcept {
+    genPawnPushesN(pawns, empty_squares, ~0ULL, enemy_pawns, out_to);
+  }
   // generates quiet pawn moves (for black)
   // first one is the double-pushes, then single-pushes
+  // only pushes landing on targets are added
   // ! adds at most 16 Moves to out_to
+  template <class MoveSink>
   void genPawnPushesS(Bitboards::bb pawns, Bitboards::bb empty_squares
-    , Bitboards::bb enemy_pawns, std::vector<Move>& out_to) noexcept;
+    , Bitboards::bb targets, Bitboards::bb enemy_pawns, MoveSink& out_to) noexcept;
+  template <class MoveSink>
+  inline void genPawnPushesS(Bitboards::bb pawns, Bitboards::bb empty_squares
+    , Bitboards::bb enemy_pawns, MoveSink& out_to) noexcept {
+    genPawnPushesS(pawns, empty_squares, ~0ULL, enemy_pawns, out_to);
+  }
   // generates pawn capture moves (for white)
   // ! adds at most 14 Moves to out_to
+  template <class MoveSink>
   void genPawnCapsN(Bitboards::bb from_pawns, Bitboards::bb targets
-    , std::vector<Move>& out_to) noexcept;
+    , MoveSink& out_to) noexcept;
   // generates pawn capture moves (for black)
   // ! adds at most 14 Moves to out_to
+  template <class MoveSink>
   void genPawnCapsS(Bitboards::bb from_pawns, Bitboards::bb targets
-    , std::vector<Move>& out_to) noexcept;
+    , MoveSink& out_to) noexcept;
   // generates quiet knight moves
   // ! normal game adds at most 16 Moves to out_to, but
   // ! worst-case endgame could add as many as 80
+  template <class MoveSink>
   void genKnightMoves(Bitboards::bb knights, Bitboards::bb valid_targets
-    , std::vector<Move>& out_to) noexcept;
+    , MoveSink& out_to) noexcept;
   // generates knight captures
+  template <class MoveSink>
   void genKnightCaps(Bitboards::bb knights, Bitboards::bb enemy_pieces
-    , std::vector<Move>& out_to) noexcept;
+    , MoveSink& out_to) noexcept;
   // generate quiet bishop moves
   // ! normal game adds at most 26 Moves to out_to, but
   // ! worst-case endgame could add as many as 130
+  // only slides landing on targets are added
+  template <class MoveSink>
   void genBishopMoves(Bitboards::bb bishops, Bitboards::bb empty_squares
-    , std::vector<Move>& out_to) noexcept;
+    , Bitboards::bb targets, MoveSink& out_to) noexcept;
+  template <class MoveSink>
+  inline void genBishopMoves(Bitboards::bb bishops, Bitboards::bb empty_squares
+    , MoveSink& out_to) noexcept {
+    genBishopMoves(bishops, empty_squares, ~0ULL, out_to);
+  }
   // generate bishop captures
+  template <class MoveSink>
   void genBishopCaps(Bitboards::bb bishops, Bitboards::bb empty_squares
-    , Bitboards::bb enemy_pieces, std::vector<Move>& out_to) noexcept;
+    , Bitboards::bb enemy_pieces, MoveSink& out_to) noexcept;
   // generate quiet rook moves
   // ! normal game adds at most 28 Moves to out_to, but
   // ! worst-case endgame could add as many as 140
+  // only slides landing on targets are added
+  template <class MoveSink>
   void genRookMoves(Bitboards::bb rooks, Bitboards::bb empty_squares
-    , std::vector<Move>& out_to) noexcept;
+    , Bitboards::bb targets, MoveSink& out_to) noexcept;
+  template <class MoveSink>
+  inline void genRookMoves(Bitboards::bb rooks, Bitboards::bb empty_squares
+    , MoveSink& out_to) noexcept {
+    genRookMoves(rooks, empty_squares, ~0ULL, out_to);
+  }
   // generate rook captures
+  template <class MoveSink>
   void genRookCaps(Bitboards::bb rooks, Bitboards::bb empty_squares
-    , Bitboards::bb enemy_pieces, std::vector<Move>& out_to) noexcept;
+    , Bitboards::bb enemy_pieces, MoveSink& out_to) noexcept;
   // generate quiet queen moves
   // ! normal game adds at most 27 Moves to out_to, but
   // ! worst-case endgame could add as many as 243
+  template <class MoveSink>
+  inline void genQueenMoves(Bitboards::bb queens, Bitboards::bb empty_squares
+    , Bitboards::bb targets, MoveSink& out_to) noexcept {
+    genBishopMoves(queens, empty_squares, targets, out_to);
+    genRookMoves(queens, empty_squares, targets, out_to);
+  }
+  template <class MoveSink>
   inline void genQueenMoves(Bitboards::bb queens
-    , Bitboards::bb empty_squares, std::vector<Move>& out_to) noexcept {
-    genBishopMoves(queens, empty_squares, out_to);
-    genRookMoves(queens, empty_squares, out_to);
+    , Bitboards::bb empty_squares, MoveSink& out_to) noexcept {
+    genQueenMoves(queens, empty_squares, ~0ULL, out_to);
   }
   // generate queen captures
+  template <class MoveSink>
   inline void genQueenCaps(Bitboards::bb queens
     , Bitboards::bb empty_squares, Bitboards::bb enemy_pieces
-    , std::vector<Move>& out_to) noexcept {
+    , MoveSink& out_to) noexcept {
     genBishopCaps(queens, empty_squares, enemy_pieces, out_to);
     genRookCaps(queens, empty_squares, enemy_pieces, out_to);
   }
   // generate all king moves (quiet, capture, and castle)
   // ! adds between 8 and 10 Moves to out_to, depending on castling rights
+  template <class MoveSink>
   void genKingMoves(Bitboards::bb king, Bitboards::bb empty_squares
     , Bitboards::bb not_threatened, Bitboards::bb enemy_pieces, bool castle_queenside
-    , bool castle_kingside, std::vector<Move>& out_to) noexcept;
+    , bool castle_kingside, MoveSink& out_to) noexcept;
 
   // the following functions generate bitboards that help with check, pins, etc
 
@@ -162,21 +210,27 @@ namespace Movegen {
     bb we_2 = shift2W(from_knights) | shift2E(from_knights);
     return shift2N(we_1) | shiftN(we_2) | shiftS(we_2) | shift2S(we_1);
   }
+  // sliders look up each piece's attacks in the tables from magic.h;
+  // Bitboards::fill<X>Attacks() computes the same thing set-wise
   inline Bitboards::bb genBishopThreats(Bitboards::bb from_bishops
     , Bitboards::bb empty_squares) noexcept {
     using namespace Bitboards;
-    return shiftNW(obstructedFillNW(from_bishops, empty_squares))
-      | shiftNE(obstructedFillNE(from_bishops, empty_squares))
-      | shiftSW(obstructedFillSW(from_bishops, empty_squares))
-      | shiftSE(obstructedFillSE(from_bishops, empty_squares));
+    bb threats = 0;
+    while (from_bishops) {
+      int from = Binary::popLS1B(&from_bishops);
+      threats |= bishopAttacks(from, ~empty_squares);
+    }
+    return threats;
   }
   inline Bitboards::bb genRookThreats(Bitboards::bb from_rooks
     , Bitboards::bb empty_squares) noexcept {
     using namespace Bitboards;
-    return shiftN(obstructedFillN(from_rooks, empty_squares))
-      | shiftE(obstructedFillE(from_rooks, empty_squares))
-      | shiftS(obstructedFillS(from_rooks, empty_squares))
-      | shiftW(obstructedFillW(from_rooks, empty_squares));
+    bb threats = 0;
+    while (from_rooks) {
+      int from = Binary::popLS1B(&from_rooks);
+      threats |= rookAttacks(from, ~empty_squares);
+    }
+    return threats;
   }
   inline Bitboards::bb genQueenThreats(Bitboards::bb from_queens
     , Bitboards::bb empty_squares) noexcept {
@@ -192,24 +246,27 @@ namespace Movegen {
     threats &= ~from_king;
     return threats;
   }
+  // threat maps cover every enemy slider at once, so they stay set-wise
   inline Bitboards::bb genAllThreatsWhite(Bitboards::bb from_pawns
     , Bitboards::bb from_knights, Bitboards::bb from_bishoplike
     , Bitboards::bb from_rooklike, Bitboards::bb from_king
     , Bitboards::bb empty_squares) noexcept {
+    using namespace Bitboards;
     return genPawnThreatsN(from_pawns)
       | genKnightThreats(from_knights)
-      | genBishopThreats(from_bishoplike, empty_squares)
-      | genRookThreats(from_rooklike, empty_squares)
+      | fillBishopAttacks(from_bishoplike, empty_squares)
+      | fillRookAttacks(from_rooklike, empty_squares)
       | genKingThreats(from_king);
   }
   inline Bitboards::bb genAllThreatsBlack(Bitboards::bb from_pawns
     , Bitboards::bb from_knights, Bitboards::bb from_bishoplike
     , Bitboards::bb from_rooklike, Bitboards::bb from_king
     , Bitboards::bb empty_squares) noexcept {
+    using namespace Bitboards;
     return genPawnThreatsS(from_pawns)
       | genKnightThreats(from_knights)
-      | genBishopThreats(from_bishoplike, empty_squares)
-      | genRookThreats(from_rooklike, empty_squares)
+      | fillBishopAttacks(from_bishoplike, empty_squares)
+      | fillRookAttacks(from_rooklike, empty_squares)
       | genKingThreats(from_king);
   }
 }
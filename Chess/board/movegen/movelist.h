@@ -0,0 +1,41 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+// a fixed-capacity list of Moves that lives on the stack,
+// so generating moves at each node never touches the heap.
+// it has the same interface as std::vector<Move> as far as
+// the Movegen functions are concerned, so either can be used as a sink
+
+#include <cstddef>
+
+#include "move.h"
+
+class MoveList {
+public:
+  // no legal position has more than 218 moves,
+  // so this can never overflow for legal move generation
+  constexpr static inline size_t capacity = 256;
+
+  inline MoveList() noexcept : count(0) {}
+
+  inline void push_back(Move move) noexcept { moves[count++] = move; }
+  inline void clear() noexcept { count = 0; }
+
+  inline size_t size() const noexcept { return count; }
+  inline bool empty() const noexcept { return count == 0; }
+
+  inline Move& operator[](size_t idx) noexcept { return moves[idx]; }
+  inline const Move& operator[](size_t idx) const noexcept { return moves[idx]; }
+
+  inline Move* begin() noexcept { return moves; }
+  inline Move* end() noexcept { return moves + count; }
+  inline const Move* begin() const noexcept { return moves; }
+  inline const Move* end() const noexcept { return moves + count; }
+
+private:
+  // left uninitialized on purpose; only the first count Moves are valid
+  Move moves[capacity];
+  size_t count;
+};
+
+#endif // MOVELIST_H
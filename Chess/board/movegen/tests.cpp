@@ -75,10 +75,10 @@ int main() {
         passing = false;
         break;
       }
-      else if (move.getPromoType() == Piece::knight) found[0] = true;
-      else if (move.getPromoType() == Piece::bishop) found[1] = true;
-      else if (move.getPromoType() == Piece::rook) found[2] = true;
-      else if (move.getPromoType() == Piece::queen) found[3] = true;
+      else if (move.getPromoType() == Move::knight) found[0] = true;
+      else if (move.getPromoType() == Move::bishop) found[1] = true;
+      else if (move.getPromoType() == Move::rook) found[2] = true;
+      else if (move.getPromoType() == Move::queen) found[3] = true;
     }
     if (passing) {
       if (!(found[0] && found[1] && found[2] && found[3]))
@@ -348,4 +348,42 @@ int main() {
   if (legalMoveTargetsWhite(e1, ~e1 & ~e5 & ~h4, 0, 0, h4, e5) != 0)
     cout << "[FAIL]" << endl;
   else cout << "[PASS]" << endl;
+
+  cout << endl << "Testing leaper attack tables against shifts...";
+  {
+    int mismatches = 0;
+    for (int idx = 0; idx < 64; ++idx) {
+      bb square = idxToBoard(idx);
+      if (knight_attacks[idx] != genKnightThreats(square)) ++mismatches;
+      if (king_attacks[idx] != genKingThreats(square)) ++mismatches;
+      if (pawn_attacks[1][idx] != genPawnThreatsN(square)) ++mismatches;
+      if (pawn_attacks[0][idx] != genPawnThreatsS(square)) ++mismatches;
+    }
+    if (mismatches) cout << "[FAIL] " << mismatches << " mismatched attack sets" << endl;
+    else cout << "[PASS]" << endl;
+  }
+
+  cout << "Testing slider attack tables against fills...";
+  {
+    // xorshift64, so the occupancies are the same every run
+    uint64_t state = 0x123456789abcdef;
+    auto next = [&state]() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+    };
+    int mismatches = 0;
+    for (int trial = 0; trial < 1000; ++trial) {
+      // sparse & dense boards both
+      bb occupied = (trial & 1) ? next() : next() & next() & next();
+      for (int idx = 0; idx < 64; ++idx) {
+        bb square = idxToBoard(idx);
+        if (bishopAttacks(idx, occupied) != fillBishopAttacks(square, ~occupied)) ++mismatches;
+        if (rookAttacks(idx, occupied) != fillRookAttacks(square, ~occupied)) ++mismatches;
+      }
+    }
+    if (mismatches) cout << "[FAIL] " << mismatches << " mismatched attack sets" << endl;
+    else cout << "[PASS]" << endl;
+  }
 }
@@ -0,0 +1,83 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+// defines a compact binary encoding of a position, for datasets & caches
+// where FEN is too big & too slow to parse: 32 bytes, laid out as
+//   bytes  0-7   the occupied squares, a little-endian bitboard
+//   bytes  8-23  a nibble per occupied square, from the lowest square up
+//                (low nibble first): the piece type (pawn = 0 ... king = 5),
+//                plus 8 for white; the nibbles after the last piece are 0
+//   byte   24    bit 0 set when white is to move, bits 1-4 the castling rights
+//                (white queenside, white kingside, black queenside, black kingside)
+//   byte   25    the en passant square + 1, or 0 for none
+//   bytes 26-27  the halfmove clock, little-endian
+//   bytes 28-29  the fullmove number, little-endian
+//   bytes 30-31  0 (keeps records aligned, so a file can be indexed directly)
+// there is room for 32 pieces, as in any position reachable from the start.
+// files of packed positions are just the records back to back, with no
+// header, so they can be concatenated, split & seeked into freely
+//
+// For more info, read https://www.chessprogramming.org/Encoding_Positions
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace Packed {
+  constexpr size_t position_size = 32;
+  constexpr int max_pieces = 32;
+
+  struct Position {
+    uint8_t bytes[position_size];
+  };
+  static_assert(sizeof(Position) == position_size, "packed positions must have no padding");
+
+  // writes packed positions to a stream, one record after another
+  class Writer {
+  public:
+    explicit Writer(std::ostream& out) noexcept : out(out), count(0) {}
+
+    // returns false if the stream failed
+    inline bool write(const Position& position) {
+      out.write(reinterpret_cast<const char*>(position.bytes), position_size);
+      if (!out) return false;
+      ++count;
+      return true;
+    }
+    // the number of records written without the stream failing
+    inline uint64_t getCount() const noexcept { return count; }
+
+  private:
+    std::ostream& out;
+    uint64_t count;
+  };
+
+  // reads packed positions back from a stream
+  class Reader {
+  public:
+    explicit Reader(std::istream& in) noexcept : in(in), count(0), truncated(false) {}
+
+    // returns false at the end of the stream
+    inline bool read(Position& position) {
+      in.read(reinterpret_cast<char*>(position.bytes), position_size);
+      if (in.gcount() == static_cast<std::streamsize>(position_size)) {
+        ++count;
+        return true;
+      }
+      // a stream that ends partway through a record was cut short
+      truncated = in.gcount() > 0;
+      return false;
+    }
+    inline uint64_t getCount() const noexcept { return count; }
+    // whether the stream ended partway through a record
+    inline bool isTruncated() const noexcept { return truncated; }
+
+  private:
+    std::istream& in;
+    uint64_t count;
+    bool truncated;
+  };
+}
+
+#endif // PACKED_H
@@ -0,0 +1,172 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+// defines the piece-square tables: what each piece is worth on each square,
+// once for the middlegame & once for the endgame.
+// a position's score is the sum over its pieces, so (like the Zobrist key)
+// Board keeps it up to date by adding & subtracting as pieces move, & the
+// evaluation blends the two halves by how much material is left (the phase)
+//
+// For more info, read https://www.chessprogramming.org/Piece-Square_Tables
+// and https://www.chessprogramming.org/Tapered_Eval
+
+#include <cstdint>
+
+namespace PSQT {
+  // a middlegame & an endgame score, always from white's point of view
+  struct Score {
+    int mg;
+    int eg;
+
+    constexpr inline Score& operator+=(const Score& rhs) noexcept {
+      mg += rhs.mg;
+      eg += rhs.eg;
+      return *this;
+    }
+    constexpr inline Score& operator-=(const Score& rhs) noexcept {
+      mg -= rhs.mg;
+      eg -= rhs.eg;
+      return *this;
+    }
+    constexpr inline bool operator==(const Score& rhs) const noexcept {
+      return mg == rhs.mg && eg == rhs.eg;
+    }
+    constexpr inline bool operator!=(const Score& rhs) const noexcept { return !(*this == rhs); }
+  };
+
+  // the piece types in the order used to index the tables (as in Zobrist)
+  enum PieceIDX : int {
+    pawn = 0, knight = 1, bishop = 2, rook = 3, queen = 4, king = 5,
+  };
+
+  constexpr Score material[6] = {
+    { 82, 94 }, { 337, 281 }, { 365, 297 }, { 477, 512 }, { 1025, 936 }, { 0, 0 },
+  };
+
+  // how much each piece counts towards the middlegame; a full set of
+  // pieces is max_phase, bare kings & pawns are 0
+  constexpr int phase_weight[6] = { 0, 1, 1, 2, 4, 0 };
+  constexpr int max_phase = 24;
+
+  // the tables below are drawn from white's side of the board:
+  // the top row is rank 8 & each row runs from the a-file to the h-file
+  typedef int Table[64];
+
+  constexpr Table pawn_mg = {
+     0,   0,   0,   0,   0,   0,   0,   0,
+    50,  50,  50,  50,  50,  50,  50,  50,
+    10,  10,  20,  30,  30,  20,  10,  10,
+     5,   5,  10,  25,  25,  10,   5,   5,
+     0,   0,   0,  20,  20,   0,   0,   0,
+     5,  -5, -10,   0,   0, -10,  -5,   5,
+     5,  10,  10, -20, -20,  10,  10,   5,
+     0,   0,   0,   0,   0,   0,   0,   0,
+  };
+  // in the endgame a pawn is worth more the closer it is to promoting
+  constexpr Table pawn_eg = {
+     0,   0,   0,   0,   0,   0,   0,   0,
+    80,  80,  80,  80,  80,  80,  80,  80,
+    50,  50,  50,  50,  50,  50,  50,  50,
+    30,  30,  30,  30,  30,  30,  30,  30,
+    15,  15,  15,  15,  15,  15,  15,  15,
+     5,   5,   5,   5,   5,   5,   5,   5,
+     0,   0,   0,   0,   0,   0,   0,   0,
+     0,   0,   0,   0,   0,   0,   0,   0,
+  };
+  constexpr Table knight_both = {
+   -50, -40, -30, -30, -30, -30, -40, -50,
+   -40, -20,   0,   0,   0,   0, -20, -40,
+   -30,   0,  10,  15,  15,  10,   0, -30,
+   -30,   5,  15,  20,  20,  15,   5, -30,
+   -30,   0,  15,  20,  20,  15,   0, -30,
+   -30,   5,  10,  15,  15,  10,   5, -30,
+   -40, -20,   0,   5,   5,   0, -20, -40,
+   -50, -40, -30, -30, -30, -30, -40, -50,
+  };
+  constexpr Table bishop_both = {
+   -20, -10, -10, -10, -10, -10, -10, -20,
+   -10,   0,   0,   0,   0,   0,   0, -10,
+   -10,   0,   5,  10,  10,   5,   0, -10,
+   -10,   5,   5,  10,  10,   5,   5, -10,
+   -10,   0,  10,  10,  10,  10,   0, -10,
+   -10,  10,  10,  10,  10,  10,  10, -10,
+   -10,   5,   0,   0,   0,   0,   5, -10,
+   -20, -10, -10, -10, -10, -10, -10, -20,
+  };
+  constexpr Table rook_both = {
+     0,   0,   0,   0,   0,   0,   0,   0,
+     5,  10,  10,  10,  10,  10,  10,   5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+    -5,   0,   0,   0,   0,   0,   0,  -5,
+     0,   0,   0,   5,   5,   0,   0,   0,
+  };
+  constexpr Table queen_both = {
+   -20, -10, -10,  -5,  -5, -10, -10, -20,
+   -10,   0,   0,   0,   0,   0,   0, -10,
+   -10,   0,   5,   5,   5,   5,   0, -10,
+    -5,   0,   5,   5,   5,   5,   0,  -5,
+     0,   0,   5,   5,   5,   5,   0,  -5,
+   -10,   5,   5,   5,   5,   5,   0, -10,
+   -10,   0,   5,   0,   0,   0,   0, -10,
+   -20, -10, -10,  -5,  -5, -10, -10, -20,
+  };
+  // the king hides behind its pawns in the middlegame...
+  constexpr Table king_mg = {
+   -30, -40, -40, -50, -50, -40, -40, -30,
+   -30, -40, -40, -50, -50, -40, -40, -30,
+   -30, -40, -40, -50, -50, -40, -40, -30,
+   -30, -40, -40, -50, -50, -40, -40, -30,
+   -20, -30, -30, -40, -40, -30, -30, -20,
+   -10, -20, -20, -20, -20, -20, -20, -10,
+    20,  20,   0,   0,   0,   0,  20,  20,
+    20,  30,  10,   0,   0,  10,  30,  20,
+  };
+  // ...& heads for the centre in the endgame
+  constexpr Table king_eg = {
+   -50, -40, -30, -20, -20, -30, -40, -50,
+   -30, -20, -10,   0,   0, -10, -20, -30,
+   -30, -10,  20,  30,  30,  20, -10, -30,
+   -30, -10,  30,  40,  40,  30, -10, -30,
+   -30, -10,  30,  40,  40,  30, -10, -30,
+   -30, -10,  20,  30,  30,  20, -10, -30,
+   -30, -30,   0,   0,   0,   0, -30, -30,
+   -50, -30, -30, -30, -30, -30, -30, -50,
+  };
+
+  // indexed [is_white][PieceIDX][square], with material included
+  // & black's scores mirrored & negated
+  struct Tables {
+    Score piece_square[2][6][64];
+  };
+
+  constexpr inline Tables generateTables() noexcept {
+    const int* mg[6] = { pawn_mg, knight_both, bishop_both, rook_both, queen_both, king_mg };
+    const int* eg[6] = { pawn_eg, knight_both, bishop_both, rook_both, queen_both, king_eg };
+    Tables t{};
+    for (int type = 0; type < 6; ++type) {
+      for (int idx = 0; idx < 64; ++idx) {
+        // squares are indexed file * 8 + rank
+        int file = idx / 8, rank = idx % 8;
+        int white_row = (7 - rank) * 8 + file, black_row = rank * 8 + file;
+        t.piece_square[1][type][idx] = { material[type].mg + mg[type][white_row]
+          , material[type].eg + eg[type][white_row] };
+        t.piece_square[0][type][idx] = { -(material[type].mg + mg[type][black_row])
+          , -(material[type].eg + eg[type][black_row]) };
+      }
+    }
+    return t;
+  }
+
+  constexpr inline Tables tables = generateTables();
+
+  // blends a score by phase, from pure endgame (0) to pure middlegame (max_phase)
+  constexpr inline int taper(Score score, int phase) noexcept {
+    if (phase > max_phase) phase = max_phase;
+    return (score.mg * phase + score.eg * (max_phase - phase)) / max_phase;
+  }
+}
+
+#endif // PSQT_H
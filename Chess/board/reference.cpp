@@ -0,0 +1,166 @@
+#include "reference.h"
+
+using Indexing::getFileIDX, Indexing::getRankIDX;
+
+namespace {
+  // the square at (file, rank), or -1 if it's off the board
+  int squareAt(int file, int rank) noexcept {
+    if (file < 0 || file >= 8 || rank < 0 || rank >= 8) return -1;
+    return file * 8 + rank;
+  }
+
+  // offsets as { file, rank }
+  constexpr int knight_offsets[8][2] = {
+    { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 }
+  };
+  constexpr int king_offsets[8][2] = {
+    { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }, { -1, 0 }, { -1, 1 }
+  };
+  constexpr int diagonals[4][2] = { { 1, 1 }, { 1, -1 }, { -1, -1 }, { -1, 1 } };
+  constexpr int orthogonals[4][2] = { { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 } };
+
+  bool isColor(Piece::Name p, bool white) noexcept {
+    return (white) ? Piece::isWhite(p) : Piece::isBlack(p);
+  }
+
+  // the first piece found walking from idx in direction (df, dr), or a square if none
+  Piece::Name firstAlongRay(const Board& board, int idx, int df, int dr) noexcept {
+    int file = getFileIDX(idx) + df, rank = getRankIDX(idx) + dr;
+    for (int sq = squareAt(file, rank); sq != -1; sq = squareAt(file, rank)) {
+      if (!Piece::isSquare(board.getPiece(sq))) return board.getPiece(sq);
+      file += df;
+      rank += dr;
+    }
+    return Piece::square;
+  }
+
+  void addPawnMove(int from, int to, bool promotes, std::vector<Move>& moves) {
+    if (promotes) {
+      moves.push_back(Move(from, to, Move::queen, Move::promo));
+      moves.push_back(Move(from, to, Move::rook, Move::promo));
+      moves.push_back(Move(from, to, Move::bishop, Move::promo));
+      moves.push_back(Move(from, to, Move::knight, Move::promo));
+    }
+    else moves.push_back(Move(from, to));
+  }
+
+  void genPseudoLegal(const Board& board, std::vector<Move>& moves) {
+    bool white = board.isWhitesMove();
+    for (int from = 0; from < 64; ++from) {
+      Piece::Name p = board.getPiece(from);
+      if (!isColor(p, white)) continue;
+      int file = getFileIDX(from), rank = getRankIDX(from);
+
+      switch (Piece::getType(p)) {
+      case Piece::pawn: {
+        int dir = (white) ? 1 : -1;
+        int start_rank = (white) ? 1 : 6, promo_rank = (white) ? 7 : 0;
+        int one = squareAt(file, rank + dir);
+        if (one != -1 && Piece::isSquare(board.getPiece(one))) {
+          addPawnMove(from, one, rank + dir == promo_rank, moves);
+          int two = squareAt(file, rank + 2 * dir);
+          if (rank == start_rank && Piece::isSquare(board.getPiece(two))) {
+            // flag the push if an enemy pawn could take it en passant
+            Piece::Name enemy_pawn = Piece::makePiece(Piece::pawn, !white);
+            int left = squareAt(file - 1, rank + 2 * dir), right = squareAt(file + 1, rank + 2 * dir);
+            bool capturable = (left != -1 && board.getPiece(left) == enemy_pawn)
+              || (right != -1 && board.getPiece(right) == enemy_pawn);
+            moves.push_back((capturable) ? Move(from, two, Move::en_passant) : Move(from, two));
+          }
+        }
+        for (int df : { -1, 1 }) {
+          int to = squareAt(file + df, rank + dir);
+          if (to == -1) continue;
+          if (isColor(board.getPiece(to), !white)) addPawnMove(from, to, rank + dir == promo_rank, moves);
+          else if (to == board.getEnPassantSquare()) moves.push_back(Move(from, to));
+        }
+        break;
+      }
+      case Piece::knight:
+      case Piece::king: {
+        const int (*offsets)[2] = (Piece::isKnight(p)) ? knight_offsets : king_offsets;
+        for (int i = 0; i < 8; ++i) {
+          int to = squareAt(file + offsets[i][0], rank + offsets[i][1]);
+          if (to != -1 && !isColor(board.getPiece(to), white)) moves.push_back(Move(from, to));
+        }
+        break;
+      }
+      case Piece::bishop:
+      case Piece::rook:
+      case Piece::queen: {
+        for (int i = 0; i < 8; ++i) {
+          const int* dir = (i < 4) ? diagonals[i] : orthogonals[i - 4];
+          if (i < 4 && Piece::isRook(p)) continue;
+          if (i >= 4 && Piece::isBishop(p)) continue;
+          for (int step = 1; ; ++step) {
+            int to = squareAt(file + step * dir[0], rank + step * dir[1]);
+            if (to == -1 || isColor(board.getPiece(to), white)) break;
+            moves.push_back(Move(from, to));
+            if (!Piece::isSquare(board.getPiece(to))) break;
+          }
+        }
+        break;
+      }
+      default: break;
+      }
+    }
+
+    // castling, with every condition checked directly
+    int home = (white) ? 0 : 7;
+    int king_from = squareAt(4, home);
+    if (board.getPiece(king_from) != Piece::makePiece(Piece::king, white)) return;
+    if (Reference::isAttacked(board, king_from, !white)) return;
+    Piece::Name rook = Piece::makePiece(Piece::rook, white);
+    auto empty = [&](int f) { return Piece::isSquare(board.getPiece(squareAt(f, home))); };
+    auto safe = [&](int f) { return !Reference::isAttacked(board, squareAt(f, home), !white); };
+    if (board.canCastleKingside(white) && board.getPiece(squareAt(7, home)) == rook
+      && empty(5) && empty(6) && safe(5) && safe(6)) {
+      moves.push_back(Move(king_from, squareAt(6, home), Move::castling));
+    }
+    if (board.canCastleQueenside(white) && board.getPiece(squareAt(0, home)) == rook
+      && empty(1) && empty(2) && empty(3) && safe(2) && safe(3)) {
+      moves.push_back(Move(king_from, squareAt(2, home), Move::castling));
+    }
+  }
+}
+
+bool Reference::isAttacked(const Board& board, int idx, bool by_white) noexcept {
+  int file = getFileIDX(idx), rank = getRankIDX(idx);
+
+  // a pawn attacks diagonally forwards, so look diagonally backwards from idx
+  int pawn_rank = rank + ((by_white) ? -1 : 1);
+  for (int df : { -1, 1 }) {
+    int sq = squareAt(file + df, pawn_rank);
+    if (sq != -1 && board.getPiece(sq) == Piece::makePiece(Piece::pawn, by_white)) return true;
+  }
+  for (int i = 0; i < 8; ++i) {
+    int sq = squareAt(file + knight_offsets[i][0], rank + knight_offsets[i][1]);
+    if (sq != -1 && board.getPiece(sq) == Piece::makePiece(Piece::knight, by_white)) return true;
+    sq = squareAt(file + king_offsets[i][0], rank + king_offsets[i][1]);
+    if (sq != -1 && board.getPiece(sq) == Piece::makePiece(Piece::king, by_white)) return true;
+  }
+  Piece::Name queen = Piece::makePiece(Piece::queen, by_white);
+  for (int i = 0; i < 4; ++i) {
+    Piece::Name p = firstAlongRay(board, idx, diagonals[i][0], diagonals[i][1]);
+    if (p == queen || p == Piece::makePiece(Piece::bishop, by_white)) return true;
+    p = firstAlongRay(board, idx, orthogonals[i][0], orthogonals[i][1]);
+    if (p == queen || p == Piece::makePiece(Piece::rook, by_white)) return true;
+  }
+  return false;
+}
+
+void Reference::getAllMoves(const Board& board, std::vector<Move>& moves) {
+  bool white = board.isWhitesMove();
+  Piece::Name my_king = Piece::makePiece(Piece::king, white);
+  std::vector<Move> pseudo_legal;
+  genPseudoLegal(board, pseudo_legal);
+  for (Move move : pseudo_legal) {
+    Board after(board);
+    after.makeMove(move);
+    int king_idx = -1;
+    for (int idx = 0; idx < 64; ++idx) {
+      if (after.getPiece(idx) == my_king) king_idx = idx;
+    }
+    if (king_idx == -1 || !isAttacked(after, king_idx, !white)) moves.push_back(move);
+  }
+}
@@ -0,0 +1,22 @@
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+// a deliberately slow & simple move generator, used to check the fast one.
+// it walks the mailbox square by square, generates every pseudo-legal move,
+// then plays each one on a copy of the board and keeps it only if the
+// mover's king is not attacked afterwards.
+// it produces Moves with the same encoding as Board::getAllMoves(), so the
+// two sets can be compared directly
+
+#include <vector>
+
+#include "board.h"
+
+namespace Reference {
+  // whether any piece of the given color attacks square idx
+  bool isAttacked(const Board& board, int idx, bool by_white) noexcept;
+  // appends every legal move for the side to move
+  void getAllMoves(const Board& board, std::vector<Move>& moves);
+}
+
+#endif // REFERENCE_H
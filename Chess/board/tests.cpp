@@ -0,0 +1,177 @@
+#include "board.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::cout, std::endl;
+
+int main() {
+  cout << "Testing FEN...\n- Rejects malformed FENs...";
+  {
+    struct Case {
+      const char* fen;
+      Board::FenError error;
+    };
+    const Case cases[] = {
+      { "", Board::FenError::placement },
+      // too few ranks, a rank too long, too many pieces on a rank, too short
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1", Board::FenError::placement },
+      { "rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Board::FenError::placement },
+      { "rnbqkbnr/ppppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Board::FenError::placement },
+      { "rnbqkbnr/pppppppp/7/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Board::FenError::placement },
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNX w KQkq - 0 1", Board::FenError::placement },
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1", Board::FenError::side_to_move },
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w", Board::FenError::castling },
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkqK - 0 1", Board::FenError::castling },
+      // en passant onto the wrong rank for the side to move
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3 0 1", Board::FenError::en_passant },
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - x 1", Board::FenError::halfmove_clock },
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 99999", Board::FenError::fullmove_number },
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 moves", Board::FenError::trailing_text },
+    };
+    std::string failure;
+    for (const Case& test : cases) {
+      Board board;
+      Board::FenError error = board.parseFen(test.fen);
+      if (error != test.error || board.getKey() != 0) {
+        failure = std::string("\"") + test.fen + "\" gave \"" + Board::describe(error)
+          + "\", expected \"" + Board::describe(test.error) + "\"";
+        break;
+      }
+    }
+    if (!failure.empty()) cout << "[FAIL] " << failure << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Counters are optional...";
+  {
+    // as in EPD
+    Board board;
+    if (board.parseFen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3") != Board::FenError::none
+      || board.toFen() != "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1")
+      cout << "[FAIL] Couldn't read a FEN without counters" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Counters are read & kept up to date...";
+  {
+    Board board;
+    board.setUp("r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 12 40");
+    Board::Undo undo = board.makeMove(Move(Indexing::a + Indexing::r8, Indexing::b + Indexing::r8));
+    std::string after = board.toFen();
+    board.unmakeMove(Move(Indexing::a + Indexing::r8, Indexing::b + Indexing::r8), undo);
+    if (after != "1r2k2r/8/8/8/8/8/8/R3K2R w KQk - 13 41")
+      cout << "[FAIL] After a8b8, expected 13 41, got " << after << endl;
+    else if (board.toFen() != "r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 12 40")
+      cout << "[FAIL] Taking a8b8 back gave " << board.toFen() << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- toFen() only writes into a buffer that fits...";
+  {
+    Board board;
+    board.setUp();
+    const std::string start = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    char buf[Board::max_fen_length];
+    std::memset(buf, '#', sizeof(buf));
+    size_t too_small = board.toFen(buf, start.size());
+    bool untouched = buf[0] == '#';
+    size_t exact = board.toFen(buf, start.size() + 1);
+    if (too_small != 0 || !untouched)
+      cout << "[FAIL] Wrote into a buffer without room for the '\\0'" << endl;
+    else if (exact != start.size() || std::string(buf) != start)
+      cout << "[FAIL] Expected " << start << ", got " << buf << endl;
+    else cout << "[PASS]" << endl;
+  }
+
+  cout << "Testing packed positions...\n- Round trip...";
+  const std::vector<std::string> fens = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/8/8/KPp4r/8/8/8/7k w - c6 0 2",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 300 1234",
+  };
+  {
+    std::string failure;
+    for (const std::string& fen : fens) {
+      Board board, unpacked;
+      board.setUp(fen.c_str());
+      Packed::Position packed;
+      if (!board.pack(packed) || !unpacked.unpack(packed) || unpacked.toFen() != fen
+        || unpacked.getKey() != board.getKey()) {
+        failure = fen + " unpacked as " + unpacked.toFen();
+        break;
+      }
+    }
+    if (!failure.empty()) cout << "[FAIL] " << failure << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Streams records back to back...";
+  {
+    std::stringstream stream;
+    Packed::Writer writer(stream);
+    Board board;
+    Packed::Position packed;
+    for (const std::string& fen : fens) {
+      board.setUp(fen.c_str());
+      board.pack(packed);
+      writer.write(packed);
+    }
+    std::string bytes = stream.str();
+    Packed::Reader reader(stream);
+    std::string failure;
+    for (size_t i = 0; failure.empty() && reader.read(packed); ++i) {
+      if (!board.unpack(packed) || board.toFen() != fens[i])
+        failure = "read back " + board.toFen() + ", expected " + fens[i];
+    }
+    if (bytes.size() != fens.size() * Packed::position_size || writer.getCount() != fens.size())
+      cout << "[FAIL] Wrote " << bytes.size() << " bytes & counted " << writer.getCount()
+        << " records for " << fens.size() << " positions" << endl;
+    else if (!failure.empty()) cout << "[FAIL] " << failure << endl;
+    else if (reader.getCount() != fens.size() || reader.isTruncated())
+      cout << "[FAIL] Read " << reader.getCount() << " records of " << fens.size() << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Notices a stream cut short...";
+  {
+    Board board;
+    board.setUp();
+    Packed::Position packed;
+    board.pack(packed);
+    std::string bytes(reinterpret_cast<const char*>(packed.bytes), Packed::position_size);
+    // one whole record, then all but the last byte of another
+    std::istringstream in(bytes + bytes.substr(0, Packed::position_size - 1));
+    Packed::Reader reader(in);
+    while (reader.read(packed)) {}
+    if (reader.getCount() != 1 || !reader.isTruncated())
+      cout << "[FAIL] Read " << reader.getCount() << " records & truncated = " << reader.isTruncated() << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Writer counts only what was written...";
+  {
+    std::ostringstream out;
+    out.setstate(std::ios::badbit);
+    Packed::Writer writer(out);
+    Packed::Position packed{};
+    if (writer.write(packed) || writer.getCount() != 0)
+      cout << "[FAIL] Counted a record written to a failed stream" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Rejects corrupt records...";
+  {
+    Board board;
+    board.setUp();
+    Packed::Position packed;
+    board.pack(packed);
+    Packed::Position bad_nibble = packed, bad_padding = packed, bad_en_passant = packed;
+    // a nibble that isn't a piece, a non-zero padding byte, & en passant onto e4
+    bad_nibble.bytes[8] |= 0x7;
+    bad_padding.bytes[31] = 1;
+    bad_en_passant.bytes[25] = Indexing::e + Indexing::r4 + 1;
+    if (board.unpack(bad_nibble) || board.unpack(bad_padding) || board.unpack(bad_en_passant) || board.getKey() != 0)
+      cout << "[FAIL] Unpacked a corrupt record" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  return 0;
+}
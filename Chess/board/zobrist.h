@@ -0,0 +1,54 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+// defines the random keys used to hash a position into 64 bits.
+// a position's key is the XOR of the keys of every feature it has,
+// so making a move only has to XOR in/out the features that changed
+//
+// For more info, read https://www.chessprogramming.org/Zobrist_Hashing
+
+#include <cstdint>
+
+namespace Zobrist {
+  typedef uint64_t Key;
+
+  // the piece types in the order used to index piece_square
+  enum PieceIDX : int {
+    pawn = 0, knight = 1, bishop = 2, rook = 3, queen = 4, king = 5,
+  };
+
+  struct Keys {
+    // indexed [is_white][PieceIDX][square]
+    Key piece_square[2][6][64];
+    // indexed by the 4 castling flag bits
+    Key castling[16];
+    // indexed by the file of the en passant square
+    Key en_passant_file[8];
+    Key white_to_move;
+  };
+
+  // https://prng.di.unimi.it/splitmix64.c
+  constexpr inline Key splitMix64(uint64_t& state) noexcept {
+    Key z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+  }
+
+  constexpr inline Keys generateKeys(uint64_t seed) noexcept {
+    Keys k{};
+    for (auto& color : k.piece_square)
+      for (auto& type : color)
+        for (Key& key : type) key = splitMix64(seed);
+    // having no castling rights hashes to nothing
+    for (int i = 1; i < 16; ++i) k.castling[i] = splitMix64(seed);
+    for (Key& key : k.en_passant_file) key = splitMix64(seed);
+    k.white_to_move = splitMix64(seed);
+    return k;
+  }
+
+  // generated at compile time, so keys are identical across runs & builds
+  constexpr inline Keys keys = generateKeys(0x2545f4914f6cdd1d);
+}
+
+#endif // ZOBRIST_H
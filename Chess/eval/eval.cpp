@@ -0,0 +1,14 @@
+#include "eval.h"
+
+int Eval::evaluate(const Board& board) noexcept {
+  // material & piece placement are kept up to date by the board itself
+  int score = PSQT::taper(board.getPsqt(), board.getPhase());
+  return (board.isWhitesMove()) ? score : -score;
+}
+
+int Eval::evaluate(const Board& board, PawnTable& pawns) noexcept {
+  PSQT::Score total = board.getPsqt();
+  total += pawns.probe(board).score;
+  int score = PSQT::taper(total, board.getPhase());
+  return (board.isWhitesMove()) ? score : -score;
+}
@@ -0,0 +1,42 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+// defines the static evaluation: a score for a position without searching it,
+// in centipawns from the point of view of the side to move.
+// material & piece placement come from the board's incrementally kept
+// piece-square score (see psqt.h), tapered between middlegame & endgame,
+// so evaluating a node costs O(1); pawn structure comes from a pawn
+// hash table (see pawns.h), so it is only worked out for new pawn setups
+//
+// For more info, read https://www.chessprogramming.org/Evaluation
+
+#include "../board/board.h"
+#include "pawns.h"
+
+namespace Eval {
+  // the material value of each piece type, for exchanges
+  // (the evaluation's own, phase-dependent values are in psqt.h)
+  constexpr int pawn_value = 100;
+  constexpr int knight_value = 320;
+  constexpr int bishop_value = 330;
+  constexpr int rook_value = 500;
+  constexpr int queen_value = 900;
+
+  constexpr inline int pieceValue(Piece::Type type) noexcept {
+    switch (type) {
+    case Piece::pawn: return pawn_value;
+    case Piece::knight: return knight_value;
+    case Piece::bishop: return bishop_value;
+    case Piece::rook: return rook_value;
+    case Piece::queen: return queen_value;
+    default: return 0;
+    }
+  }
+
+  // positive when the side to move is better
+  int evaluate(const Board& board, PawnTable& pawns) noexcept;
+  // as above, but material & piece placement only (no pawn structure)
+  int evaluate(const Board& board) noexcept;
+}
+
+#endif // EVAL_H
@@ -0,0 +1,92 @@
+#include "pawns.h"
+
+using namespace Bitboards;
+
+namespace {
+  constexpr PSQT::Score doubled_penalty = { 10, 20 };
+  constexpr PSQT::Score isolated_penalty = { 10, 15 };
+  constexpr PSQT::Score backward_penalty = { 8, 10 };
+  // indexed by how far the pawn has come, from its own side
+  constexpr PSQT::Score passed_bonus[8] = {
+    { 0, 0 }, { 5, 10 }, { 10, 15 }, { 15, 25 }, { 25, 45 }, { 45, 80 }, { 70, 130 }, { 0, 0 },
+  };
+
+  // every square on or ahead of/behind the pawns
+  constexpr inline bb fillN(bb pawns) noexcept { return obstructedFillN(pawns, ~0ULL); }
+  constexpr inline bb fillS(bb pawns) noexcept { return obstructedFillS(pawns, ~0ULL); }
+  // the files on either side of the pawns (files don't wrap when shifted E/W)
+  constexpr inline bb adjacent(bb squares) noexcept { return shiftE(squares) | shiftW(squares); }
+
+  inline PSQT::Score& operator*=(PSQT::Score& score, int n) noexcept {
+    score.mg *= n;
+    score.eg *= n;
+    return score;
+  }
+  inline PSQT::Score times(PSQT::Score score, int n) noexcept { return score *= n; }
+
+  // the terms of one side's pawns, from that side's point of view
+  PSQT::Score evaluateSide(bb mine, bb theirs, bool white, bb& passed) noexcept {
+    bb (*forward)(const bb&) = (white) ? shiftN : shiftS;
+    bb (*backward)(const bb&) = (white) ? shiftS : shiftN;
+    bb (*fillForward)(bb) = (white) ? fillN : fillS;
+    bb (*fillBackward)(bb) = (white) ? fillS : fillN;
+
+    // the squares in front of each enemy pawn on its own file
+    bb their_front_span = fillBackward(backward(theirs));
+    bb my_files = fillN(mine) | fillS(mine);
+    bb their_attacks = adjacent(backward(theirs));
+    // every square my pawns could ever defend by advancing
+    bb my_attack_span = fillForward(adjacent(forward(mine)));
+
+    // a pawn with no enemy pawn ahead of it on its own or the adjacent
+    // files; only the front one of doubled pawns counts
+    passed = mine & ~(their_front_span | adjacent(their_front_span)) & ~fillBackward(backward(mine));
+    bb doubled = mine & fillBackward(backward(mine));
+    bb isolated = mine & ~adjacent(my_files);
+    // can't advance safely & can't be defended by a neighbour moving up
+    bb backward_pawns = backward(forward(mine) & their_attacks & ~my_attack_span) & ~isolated;
+
+    PSQT::Score score{ 0, 0 };
+    score -= times(doubled_penalty, Binary::countSetBits(doubled));
+    score -= times(isolated_penalty, Binary::countSetBits(isolated));
+    score -= times(backward_penalty, Binary::countSetBits(backward_pawns));
+    for (bb pawns = passed; pawns;) {
+      int rank = Binary::popLS1B(&pawns) % 8;
+      score += passed_bonus[(white) ? rank : 7 - rank];
+    }
+    return score;
+  }
+}
+
+Eval::PawnEntry Eval::evaluatePawns(bb white_pawns, bb black_pawns) noexcept {
+  PawnEntry entry{ 0, { 0, 0 }, { 0, 0 } };
+  entry.score += evaluateSide(white_pawns, black_pawns, true, entry.passed[true]);
+  entry.score -= evaluateSide(black_pawns, white_pawns, false, entry.passed[false]);
+  return entry;
+}
+
+Eval::PawnTable::PawnTable(size_t kb) : entries(), num_entries(1), stats() {
+  size_t max_entries = (kb << 10) / sizeof(PawnEntry);
+  while (num_entries * 2 <= max_entries) num_entries *= 2;
+  entries.reset(new PawnEntry[num_entries]);
+  clear();
+}
+
+void Eval::PawnTable::clear() noexcept {
+  // an empty slot reads as the position with no pawns, whose key is 0
+  // & whose terms are all 0, so it needs no separate "empty" marker
+  for (size_t i = 0; i < num_entries; ++i) entries[i] = { 0, { 0, 0 }, { 0, 0 } };
+}
+
+const Eval::PawnEntry& Eval::PawnTable::probe(const Board& board) noexcept {
+  Zobrist::Key key = board.getPawnKey();
+  PawnEntry& entry = entries[key & (num_entries - 1)];
+  ++stats.probes;
+  if (entry.key == key) {
+    ++stats.hits;
+    return entry;
+  }
+  entry = evaluatePawns(board.getPieces(Piece::white_pawn), board.getPieces(Piece::black_pawn));
+  entry.key = key;
+  return entry;
+}
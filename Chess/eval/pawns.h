@@ -0,0 +1,69 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+// defines the pawn structure evaluation: passed, doubled, isolated &
+// backward pawns, found for all pawns at once with shifts & fills.
+// the terms depend only on where the pawns stand, which changes on few
+// moves, so each search thread caches them in a small hash table keyed by
+// the board's pawn key, which is much smaller than the full key's tree
+//
+// For more info, read https://www.chessprogramming.org/Pawn_Structure
+// and https://www.chessprogramming.org/Pawn_Hash_Table
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "../board/board.h"
+
+namespace Eval {
+  struct PawnEntry {
+    Zobrist::Key key;
+    // from white's point of view, to be tapered like the piece-square score
+    PSQT::Score score;
+    // the passed pawns of each side, indexed [is_white]
+    // (kept for terms that also need the pieces, e.g. king distance)
+    Bitboards::bb passed[2];
+  };
+
+  // the pawn structure terms of a position, computed from scratch
+  PawnEntry evaluatePawns(Bitboards::bb white_pawns, Bitboards::bb black_pawns) noexcept;
+
+  // a direct-mapped cache of evaluatePawns(), owned by a single thread
+  class PawnTable {
+  public:
+    struct Stats {
+      uint64_t probes = 0;
+      uint64_t hits = 0;
+
+      inline double hitRate() const noexcept {
+        return (probes) ? static_cast<double>(hits) / probes : 0;
+      }
+      inline Stats& operator+=(const Stats& rhs) noexcept {
+        probes += rhs.probes;
+        hits += rhs.hits;
+        return *this;
+      }
+    };
+
+    explicit PawnTable(size_t kb = default_kb);
+
+    // the pawn structure of board, evaluating & storing it on a miss
+    const PawnEntry& probe(const Board& board) noexcept;
+    // empties every entry (the stats are kept)
+    void clear() noexcept;
+
+    inline const Stats& getStats() const noexcept { return stats; }
+    inline void resetStats() noexcept { stats = Stats(); }
+    inline size_t getNumEntries() const noexcept { return num_entries; }
+
+    constexpr static inline size_t default_kb = 1024;
+
+  private:
+    std::unique_ptr<PawnEntry[]> entries;
+    size_t num_entries;
+    Stats stats;
+  };
+}
+
+#endif // PAWNS_H
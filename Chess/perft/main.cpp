@@ -0,0 +1,137 @@
+// perft driver
+//
+// usage:
+//   perft                  runs the standard suite & checks the node counts
+//   perft <depth> [fen]    prints a divide of the position (start by default)
+//   perft -t <threads> [-H <hash_mb>] <depth> [fen]
+//                          runs the position serially, then split over threads
+//                          (& with a perft hash, if given) & reports the speedup
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "perft.h"
+
+using std::cout, std::endl;
+
+static void printResult(const Perft::Result& result) {
+  cout << "nodes: " << result.nodes
+    << "  time: " << std::fixed << std::setprecision(3) << result.seconds << "s"
+    << "  nps: " << std::setprecision(0) << result.nodesPerSecond() << endl;
+}
+
+static int runDivide(int depth, const std::string& fen) {
+  Board board;
+  try { board.setUp(fen.c_str()); }
+  catch (std::exception&) {
+    cout << "Invalid FEN: " << fen << endl;
+    return 1;
+  }
+  cout << board.toString();
+
+  Perft::Result total{ 0, 0 };
+  auto start = std::chrono::steady_clock::now();
+  for (Perft::DivideEntry& entry : Perft::divide(board, depth)) {
+    cout << entry.move.toUCI() << ": " << entry.nodes << endl;
+    total.nodes += entry.nodes;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  total.seconds = elapsed.count();
+  cout << endl;
+  printResult(total);
+  return 0;
+}
+
+static int runSuite() {
+  int failures = 0;
+  Perft::Result total{ 0, 0 };
+  for (const Perft::Position& pos : Perft::standardSuite()) {
+    cout << pos.name << " [" << pos.fen << "]" << endl;
+    Board board;
+    board.setUp(pos.fen);
+    for (size_t depth = 1; depth <= pos.expected.size(); ++depth) {
+      Perft::Result result = Perft::timedPerft(board, static_cast<int>(depth));
+      total.nodes += result.nodes;
+      total.seconds += result.seconds;
+      cout << "- depth " << depth << "...";
+      if (result.nodes != pos.expected[depth - 1]) {
+        cout << "[FAIL] expected " << pos.expected[depth - 1] << ", got " << result.nodes << "  ";
+        ++failures;
+      }
+      else cout << "[PASS] ";
+      printResult(result);
+    }
+  }
+  cout << endl << "total ";
+  printResult(total);
+  if (failures) cout << failures << " depth(s) failed" << endl;
+  return failures ? 1 : 0;
+}
+
+static int runParallel(int depth, const std::string& fen, int threads, size_t hash_mb) {
+  Board board;
+  try { board.setUp(fen.c_str()); }
+  catch (std::exception&) {
+    cout << "Invalid FEN: " << fen << endl;
+    return 1;
+  }
+
+  cout << "serial:              ";
+  Perft::Result serial = Perft::timedPerft(board, depth);
+  printResult(serial);
+
+  cout << threads << " thread(s)";
+  std::unique_ptr<Perft::Hash> hash;
+  if (hash_mb) {
+    hash = std::make_unique<Perft::Hash>(hash_mb);
+    cout << ", " << hash_mb << " MB hash";
+  }
+  cout << ": ";
+  Perft::Result parallel = Perft::timedParallelPerft(board, depth, threads, hash.get());
+  printResult(parallel);
+
+  if (parallel.nodes != serial.nodes) {
+    cout << "[FAIL] node counts differ" << endl;
+    return 1;
+  }
+  cout << "[PASS] speedup: " << std::fixed << std::setprecision(2)
+    << ((parallel.seconds > 0) ? serial.seconds / parallel.seconds : 0) << "x" << endl;
+  return 0;
+}
+
+static int usage() {
+  cout << "usage: perft [-t <threads> [-H <hash_mb>]] [<depth> [fen]]" << endl;
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) return runSuite();
+
+  int arg = 1, threads = 0;
+  size_t hash_mb = 0;
+  while (arg + 1 < argc && argv[arg][0] == '-') {
+    std::string option = argv[arg];
+    if (option == "-t") threads = std::atoi(argv[arg + 1]);
+    else if (option == "-H") hash_mb = std::strtoull(argv[arg + 1], nullptr, 10);
+    else return usage();
+    arg += 2;
+  }
+  if (arg >= argc) return usage();
+
+  int depth = std::atoi(argv[arg++]);
+  if (depth < 1 || (hash_mb && threads < 1)) return usage();
+  std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+  if (arg < argc) {
+    fen.clear();
+    for (int i = arg; i < argc; ++i) {
+      if (i > arg) fen += ' ';
+      fen += argv[i];
+    }
+  }
+  if (threads) return runParallel(depth, fen, threads, hash_mb);
+  return runDivide(depth, fen);
+}
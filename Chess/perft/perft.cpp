@@ -0,0 +1,201 @@
+#include "perft.h"
+
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// the slots are independent words, so relaxed ordering is enough:
+// a torn read just fails the key ^ nodes check
+constexpr static std::memory_order relaxed = std::memory_order_relaxed;
+
+Perft::Hash::Hash(size_t mb) : slots(), num_slots(1) {
+  size_t max_slots = (mb << 20) / sizeof(Slot);
+  while (num_slots * 2 <= max_slots) num_slots *= 2;
+  slots.reset(new Slot[num_slots]);
+  for (size_t i = 0; i < num_slots; ++i) {
+    slots[i].check.store(0, relaxed);
+    slots[i].nodes.store(0, relaxed);
+  }
+}
+
+bool Perft::Hash::probe(Zobrist::Key key, int depth, uint64_t& nodes) const noexcept {
+  Zobrist::Key entry_key = entryKey(key, depth);
+  const Slot& slot = slots[entry_key & (num_slots - 1)];
+  uint64_t count = slot.nodes.load(relaxed);
+  if (!count || (slot.check.load(relaxed) ^ count) != entry_key) return false;
+  nodes = count;
+  return true;
+}
+
+void Perft::Hash::store(Zobrist::Key key, int depth, uint64_t nodes) noexcept {
+  Zobrist::Key entry_key = entryKey(key, depth);
+  Slot& slot = slots[entry_key & (num_slots - 1)];
+  slot.check.store(entry_key ^ nodes, relaxed);
+  slot.nodes.store(nodes, relaxed);
+}
+
+uint64_t Perft::perft(Board& board, int depth) noexcept {
+  if (depth <= 0) return 1;
+  // the moves are already legal, so the last ply only needs counting
+  if (depth == 1) return board.countLegalMoves();
+  MoveList moves;
+  board.getAllMoves(moves);
+
+  uint64_t nodes = 0;
+  for (Move move : moves) {
+    Board::Undo undo = board.makeMove(move);
+    // the incremental key must match one built from scratch
+    assert(board.getKey() == board.computeKey());
+    nodes += perft(board, depth - 1);
+    board.unmakeMove(move, undo);
+    assert(board.getKey() == board.computeKey());
+  }
+  return nodes;
+}
+
+uint64_t Perft::perft(Board& board, int depth, Hash& hash) noexcept {
+  if (depth <= 0) return 1;
+  if (depth == 1) return board.countLegalMoves();
+  uint64_t nodes = 0;
+  // a hit saves generating the moves, not just searching them
+  if (hash.probe(board.getKey(), depth, nodes)) return nodes;
+
+  MoveList moves;
+  board.getAllMoves(moves);
+  for (Move move : moves) {
+    Board::Undo undo = board.makeMove(move);
+    nodes += perft(board, depth - 1, hash);
+    board.unmakeMove(move, undo);
+  }
+  hash.store(board.getKey(), depth, nodes);
+  return nodes;
+}
+
+namespace {
+  // a subtree to count: the moves leading to it from the root
+  struct Task {
+    Move moves[2];
+    int num_moves;
+  };
+
+  // each worker owns a queue of tasks, taking from its back; when it runs
+  // dry it steals from the front of the others' queues
+  struct TaskQueue {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  bool takeTask(std::vector<TaskQueue>& queues, size_t own, Task& task) {
+    {
+      std::lock_guard<std::mutex> guard(queues[own].lock);
+      if (!queues[own].tasks.empty()) {
+        task = queues[own].tasks.back();
+        queues[own].tasks.pop_back();
+        return true;
+      }
+    }
+    for (size_t i = 1; i < queues.size(); ++i) {
+      TaskQueue& victim = queues[(own + i) % queues.size()];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (!victim.tasks.empty()) {
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+}
+
+uint64_t Perft::parallelPerft(const Board& board, int depth, int num_threads, Hash* hash) {
+  if (depth <= 2 || num_threads <= 1) {
+    Board copy(board);
+    return (hash) ? perft(copy, depth, *hash) : perft(copy, depth);
+  }
+
+  // split the first two plies, so there are enough tasks to balance
+  // even when a few root moves have much bigger subtrees than the rest
+  std::vector<Task> tasks;
+  Board root(board);
+  MoveList root_moves;
+  root.getAllMoves(root_moves);
+  for (Move first : root_moves) {
+    Board::Undo undo = root.makeMove(first);
+    MoveList replies;
+    root.getAllMoves(replies);
+    for (Move second : replies) tasks.push_back({ { first, second }, 2 });
+    root.unmakeMove(first, undo);
+  }
+
+  std::vector<TaskQueue> queues(num_threads);
+  for (size_t i = 0; i < tasks.size(); ++i) queues[i % num_threads].tasks.push_back(tasks[i]);
+
+  std::atomic<uint64_t> total(0);
+  std::vector<std::thread> workers;
+  for (int id = 0; id < num_threads; ++id) {
+    workers.emplace_back([&, id]() {
+      uint64_t nodes = 0;
+      Board local(board);
+      Task task;
+      while (takeTask(queues, id, task)) {
+        Board::Undo undos[2];
+        for (int i = 0; i < task.num_moves; ++i) undos[i] = local.makeMove(task.moves[i]);
+        int remaining = depth - task.num_moves;
+        nodes += (hash) ? perft(local, remaining, *hash) : perft(local, remaining);
+        for (int i = task.num_moves - 1; i >= 0; --i) local.unmakeMove(task.moves[i], undos[i]);
+      }
+      total.fetch_add(nodes, relaxed);
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+  return total.load(relaxed);
+}
+
+std::vector<Perft::DivideEntry> Perft::divide(Board& board, int depth) noexcept {
+  std::vector<DivideEntry> entries;
+  MoveList moves;
+  board.getAllMoves(moves);
+  for (Move move : moves) {
+    Board::Undo undo = board.makeMove(move);
+    entries.push_back({ move, perft(board, depth - 1) });
+    board.unmakeMove(move, undo);
+  }
+  return entries;
+}
+
+const std::vector<Perft::Position>& Perft::standardSuite() noexcept {
+  static const std::vector<Position> suite = {
+    { "start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      { 20, 400, 8902, 197281, 4865609 } },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      { 48, 2039, 97862, 4085603 } },
+    // en passant discovered checks & rook endgame pins
+    { "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+      { 14, 191, 2812, 43238, 674624 } },
+    // castling rights & promotions
+    { "position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      { 6, 264, 9467, 422333 } },
+    // promotion into check
+    { "position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+      { 44, 1486, 62379, 2103487 } },
+    { "position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+      { 46, 2079, 89890, 3894594 } },
+  };
+  return suite;
+}
+
+Perft::Result Perft::timedPerft(Board& board, int depth) noexcept {
+  auto start = std::chrono::steady_clock::now();
+  uint64_t nodes = perft(board, depth);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return { nodes, elapsed.count() };
+}
+
+Perft::Result Perft::timedParallelPerft(const Board& board, int depth, int num_threads, Hash* hash) {
+  auto start = std::chrono::steady_clock::now();
+  uint64_t nodes = parallelPerft(board, depth, num_threads, hash);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return { nodes, elapsed.count() };
+}
@@ -0,0 +1,91 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+// performance test for move generation:
+// walks the legal move tree to a fixed depth and counts the leaf nodes,
+// so the results can be checked against known-good counts
+//
+// For more info, read https://www.chessprogramming.org/Perft
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../board/board.h"
+
+namespace Perft {
+  // caches the leaf counts of subtrees, keyed by the position's Zobrist key
+  // & the depth searched below it, so transpositions are only walked once.
+  // like the search's transposition table, it is shared between threads
+  // without locks: each slot holds its key XORed with its count, so a slot
+  // torn by racing writers fails verification & reads as a miss
+  class Hash {
+  public:
+    explicit Hash(size_t mb);
+
+    bool probe(Zobrist::Key key, int depth, uint64_t& nodes) const noexcept;
+    // always replaces what was in the slot
+    void store(Zobrist::Key key, int depth, uint64_t nodes) noexcept;
+
+    inline size_t getNumSlots() const noexcept { return num_slots; }
+
+  private:
+    struct Slot {
+      std::atomic<uint64_t> check;  // key ^ nodes
+      std::atomic<uint64_t> nodes;
+    };
+    // mixes the depth into the key, so one position at two depths
+    // gets two unrelated entries
+    inline static Zobrist::Key entryKey(Zobrist::Key key, int depth) noexcept {
+      uint64_t state = static_cast<uint64_t>(depth);
+      return key ^ Zobrist::splitMix64(state);
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    size_t num_slots;
+  };
+
+  // counts the leaf nodes of the move tree below board at the given depth
+  uint64_t perft(Board& board, int depth) noexcept;
+  // the same, looking subtrees up in hash before walking them
+  uint64_t perft(Board& board, int depth, Hash& hash) noexcept;
+  // the same, splitting the first two plies into tasks spread over
+  // num_threads threads; a thread that runs out of tasks steals from the others
+  // hash may be null
+  uint64_t parallelPerft(const Board& board, int depth, int num_threads, Hash* hash = nullptr);
+
+  // the leaf count below a single root move
+  struct DivideEntry {
+    Move move;
+    uint64_t nodes;
+  };
+  // runs perft to depth - 1 below each legal root move
+  std::vector<DivideEntry> divide(Board& board, int depth) noexcept;
+
+  // a reference position with its expected node counts,
+  // where expected[i] is the node count at depth i + 1
+  struct Position {
+    const char* name;
+    const char* fen;
+    std::vector<uint64_t> expected;
+  };
+  // start position, Kiwipete, and the edge-case positions from
+  // https://www.chessprogramming.org/Perft_Results
+  const std::vector<Position>& standardSuite() noexcept;
+
+  struct Result {
+    uint64_t nodes;
+    double seconds;
+    inline double nodesPerSecond() const noexcept {
+      return (seconds > 0) ? nodes / seconds : 0;
+    }
+  };
+  // runs perft and times it
+  Result timedPerft(Board& board, int depth) noexcept;
+  Result timedParallelPerft(const Board& board, int depth, int num_threads, Hash* hash = nullptr);
+}
+
+#endif // PERFT_H
@@ -0,0 +1,107 @@
+// search benchmark
+//
+// searches a few positions to a fixed depth with 1 thread, then 2, ... up to
+// max_threads, & reports how the time to reach that depth scales.
+// then, on 1 thread, turns each selective search technique off in turn
+// & reports the time to depth & the effective branching factor
+// (the nodes to reach depth over the nodes to reach depth - 1)
+//
+// usage:
+//   benchSearch [depth] [max_threads] [hash_mb]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "search.h"
+
+using std::cout, std::endl;
+
+namespace {
+  const char* const bench_positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+  };
+
+  struct Totals {
+    double seconds = 0;
+    uint64_t nodes = 0;
+    Eval::PawnTable::Stats pawn_stats;
+    Search::OrderingStats ordering;
+  };
+
+  // searches every bench position to depth, each from an empty table
+  Totals runBench(Search::TranspositionTable& tt, int depth, int threads
+    , const Search::Selectivity& selectivity = Search::Selectivity()) {
+    Search::Limits limits;
+    limits.depth = depth;
+    Totals totals;
+    for (const char* fen : bench_positions) {
+      Board board;
+      board.setUp(fen);
+      tt.clear();
+      std::atomic<bool> stop(false);
+      Search::Result result = Search::search(board, limits, tt, stop, threads, selectivity);
+      totals.seconds += result.seconds;
+      totals.nodes += result.nodes;
+      totals.pawn_stats += result.pawn_stats;
+      totals.ordering += result.ordering;
+    }
+    return totals;
+  }
+}
+
+int main(int argc, char** argv) {
+  int depth = (argc > 1) ? std::atoi(argv[1]) : 7;
+  int max_threads = (argc > 2) ? std::atoi(argv[2])
+    : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  size_t hash_mb = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 64;
+
+  Search::TranspositionTable tt(hash_mb);
+
+  cout << "Time to depth " << depth << " (" << hash_mb << " MB hash)" << endl;
+  cout << "threads      time(s)        nodes          nps  speedup  pawn hits  1st cut" << endl;
+  double serial_seconds = 0;
+  for (int threads = 1; threads <= max_threads; ++threads) {
+    Totals totals = runBench(tt, depth, threads);
+    double seconds = totals.seconds;
+    if (threads == 1) serial_seconds = seconds;
+    cout << std::setw(7) << threads
+      << std::fixed << std::setprecision(3) << std::setw(13) << seconds
+      << std::setw(13) << totals.nodes
+      << std::setprecision(0) << std::setw(13) << ((seconds > 0) ? totals.nodes / seconds : 0)
+      << std::setprecision(2) << std::setw(8) << ((seconds > 0) ? serial_seconds / seconds : 0)
+      << "x" << std::setprecision(1) << std::setw(10) << 100 * totals.pawn_stats.hitRate() << "%"
+      << std::setw(8) << 100 * totals.ordering.firstMoveCutoffRate() << "%" << endl;
+  }
+
+  struct Variant {
+    const char* name;
+    Search::Selectivity selectivity;
+  };
+  Variant variants[] = {
+    { "all", Search::Selectivity() },
+    { "no null move", { false, true, true, true } },
+    { "no LMR", { true, false, true, true } },
+    { "no futility", { true, true, false, true } },
+    { "no razoring", { true, true, true, false } },
+    { "none", { false, false, false, false } },
+  };
+  cout << endl << "Selectivity at depth " << depth << " (1 thread)" << endl;
+  cout << "variant           time(s)        nodes     EBF" << endl;
+  for (const Variant& variant : variants) {
+    Totals shallower = runBench(tt, depth - 1, 1, variant.selectivity);
+    Totals full = runBench(tt, depth, 1, variant.selectivity);
+    double ebf = (shallower.nodes) ? static_cast<double>(full.nodes) / shallower.nodes : 0;
+    cout << std::left << std::setw(14) << variant.name << std::right
+      << std::fixed << std::setprecision(3) << std::setw(11) << full.seconds
+      << std::setw(13) << full.nodes
+      << std::setprecision(2) << std::setw(8) << ebf << endl;
+  }
+  return 0;
+}
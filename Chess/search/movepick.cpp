@@ -0,0 +1,143 @@
+#include "movepick.h"
+
+#include <utility>
+
+#include "see.h"
+
+using namespace Search;
+
+namespace {
+  // larger than any MVV-LVA score
+  constexpr int bad_capture_penalty = 1 << 12;
+
+  // rough piece values for ordering only, indexed by victim/attacker
+  inline int orderingValue(Piece::Type type) noexcept {
+    switch (type) {
+    case Piece::pawn: return 1;
+    case Piece::knight: return 3;
+    case Piece::bishop: return 3;
+    case Piece::rook: return 5;
+    case Piece::queen: return 9;
+    case Piece::king: return 20;
+    default: return 0;
+    }
+  }
+}
+
+int Search::mvvLva(const Board& board, Move move) noexcept {
+  Piece::Name victim = board.getPiece(move.getToSquare());
+  // en passant is the only capture onto an empty square
+  int victim_value = (Piece::isSquare(victim)) ? orderingValue(Piece::pawn)
+    : orderingValue(Piece::getType(victim));
+  int attacker_value = orderingValue(Piece::getType(board.getPiece(move.getFromSquare())));
+  int score = victim_value * 32 - attacker_value;
+  if (move.getSpecial() == Move::promo) score += orderingValue(move.getPromoPieceType()) * 32;
+  return score;
+}
+
+MovePicker::MovePicker(const Board& board, Move tt_move, Move killer_1, Move killer_2
+  , Move countermove, const History* history) noexcept
+  : board(board), tt_move(tt_move), killers{ killer_1, killer_2 }, killer_idx(0)
+  , countermove(countermove), history(history)
+  , stage(stage_tt), quiescence(false), moves(), current(0) {
+  // a table move that isn't legal here is dropped, so it can't shadow a real move
+  if (!tt_move.isNone() && !board.isLegal(tt_move)) this->tt_move = Move::none();
+  if (killers[1] == killers[0]) killers[1] = Move::none();
+  if (this->countermove == killers[0] || this->countermove == killers[1]) this->countermove = Move::none();
+}
+
+MovePicker::MovePicker(const Board& board) noexcept
+  : board(board), tt_move(Move::none()), killers{ Move::none(), Move::none() }, killer_idx(0)
+  , countermove(Move::none()), history(nullptr)
+  , stage(stage_gen_captures), quiescence(true), moves(), current(0) {}
+
+void MovePicker::pickBest() noexcept {
+  size_t best = current;
+  for (size_t i = current + 1; i < moves.size(); ++i) {
+    if (scores[i] > scores[best]) best = i;
+  }
+  std::swap(moves[current], moves[best]);
+  std::swap(scores[current], scores[best]);
+}
+
+Move MovePicker::next() noexcept {
+  switch (stage) {
+  case stage_tt:
+    stage = stage_gen_captures;
+    if (!tt_move.isNone()) return tt_move;
+    [[fallthrough]];
+  case stage_gen_captures:
+    moves.clear();
+    board.getCaptures(moves);
+    for (size_t i = 0; i < moves.size(); ++i) {
+      scores[i] = mvvLva(board, moves[i]);
+      // captures that lose material in the exchange go after the rest
+      if (losesMaterial(board, moves[i])) scores[i] -= bad_capture_penalty;
+    }
+    current = 0;
+    stage = stage_captures;
+    [[fallthrough]];
+  case stage_captures:
+    while (current < moves.size()) {
+      pickBest();
+      Move move = moves[current++];
+      if (move != tt_move) return move;
+    }
+    if (quiescence) {
+      stage = stage_gen_promos;
+      return next();
+    }
+    stage = stage_killers;
+    [[fallthrough]];
+  case stage_killers:
+    while (killer_idx < 2) {
+      Move killer = killers[killer_idx++];
+      if (killer.isNone() || killer == tt_move) continue;
+      if (board.isCapture(killer) || !board.isLegal(killer)) continue;
+      return killer;
+    }
+    stage = stage_countermove;
+    [[fallthrough]];
+  case stage_countermove:
+    stage = stage_gen_quiets;
+    if (!countermove.isNone() && countermove != tt_move
+      && !board.isCapture(countermove) && board.isLegal(countermove)) return countermove;
+    [[fallthrough]];
+  case stage_gen_quiets:
+    moves.clear();
+    board.getQuiets(moves);
+    if (history) {
+      bool white = board.isWhitesMove();
+      for (size_t i = 0; i < moves.size(); ++i) scores[i] = history->get(white, moves[i]);
+    }
+    current = 0;
+    stage = stage_quiets;
+    [[fallthrough]];
+  case stage_quiets:
+    while (current < moves.size()) {
+      if (history) pickBest();
+      Move move = moves[current++];
+      if (!isRepeat(move)) return move;
+    }
+    stage = stage_done;
+    return Move::none();
+  case stage_gen_promos: {
+    // only pawns one step from promoting can push to promote
+    bool white = board.isWhitesMove();
+    Bitboards::bb promoting = board.getPieces((white) ? Piece::white_pawn : Piece::black_pawn)
+      & ((white) ? Bitboards::r7 : Bitboards::r2);
+    MoveList promos;
+    board.getMoves(promos, Board::gen_quiets, promoting);
+    // an underpromotion is almost never the only way to win, so
+    // quiescence leaves them to the main search
+    moves.clear();
+    for (Move move : promos)
+      if (move.getPromoType() == Move::queen) moves.push_back(move);
+    current = 0;
+    stage = stage_quiets;
+    return next();
+  }
+  default:
+    return Move::none();
+  }
+}
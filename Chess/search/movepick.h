@@ -0,0 +1,113 @@
+#ifndef MOVEPICK_H
+#define MOVEPICK_H
+
+// defines the move picker: hands a search the legal moves of a position
+// one at a time, in the order most likely to cause a cutoff.
+// each stage is only generated once the stage before it runs dry, so a
+// node that cuts off on the hash move or a capture never generates quiets
+//
+//   1. the transposition table move (if it is legal here)
+//   2. captures, most valuable victim / least valuable attacker first,
+//      except that captures losing material (by SEE) come last
+//   3. killer moves (quiet moves that cut off at the same ply elsewhere)
+//   4. the countermove (the quiet move that last refuted the move just played)
+//   5. every other quiet move, by how often it has cut off before (history)
+//
+// for the quiescence search it picks only captures & then quiet queen promotions
+//
+// For more info, read https://www.chessprogramming.org/Move_Ordering,
+// https://www.chessprogramming.org/History_Heuristic
+// and https://www.chessprogramming.org/Countermove_Heuristic
+
+#include <cstdint>
+
+#include "../board/board.h"
+
+namespace Search {
+  // orders captures by the value of the piece taken, then by the value of
+  // the piece taking it (promotions add the value gained)
+  int mvvLva(const Board& board, Move move) noexcept;
+
+  // the butterfly history table: a score for each quiet move, by side to
+  // move & the move's from & to squares, raised when it causes a cutoff &
+  // lowered when it was tried before the move that did
+  class History {
+  public:
+    History() noexcept { clear(); }
+
+    inline int get(bool white, Move move) const noexcept {
+      return table[white][move.getFromSquare()][move.getToSquare()];
+    }
+    // nudges the score towards +/-max_score by bonus, by less the closer
+    // it already is, so old results fade & scores never overflow
+    inline void update(bool white, Move move, int bonus) noexcept {
+      int16_t& entry = table[white][move.getFromSquare()][move.getToSquare()];
+      int magnitude = (bonus < 0) ? -bonus : bonus;
+      entry += bonus - entry * magnitude / max_score;
+    }
+    inline void clear() noexcept {
+      for (auto& side : table)
+        for (auto& from : side)
+          for (int16_t& entry : from) entry = 0;
+    }
+    // the bonus for a cutoff at depth (deeper cutoffs say more)
+    constexpr static inline int bonus(int depth) noexcept {
+      return (depth > 16) ? 16 * 16 : depth * depth;
+    }
+
+    constexpr static inline int max_score = 1 << 14;
+
+  private:
+    int16_t table[2][64][64];
+  };
+
+  class MovePicker {
+  public:
+    enum Stage : uint8_t {
+      stage_tt,
+      stage_gen_captures, stage_captures,
+      stage_killers, stage_countermove,
+      stage_gen_quiets, stage_quiets,
+      stage_gen_promos,
+      stage_done,
+    };
+
+    // board must outlive the picker & not change while it is in use
+    // tt_move, killers & countermove may be Move::none(), or moves that
+    // aren't legal here; quiets are left unordered without a history
+    MovePicker(const Board& board, Move tt_move
+      , Move killer_1 = Move::none(), Move killer_2 = Move::none()
+      , Move countermove = Move::none(), const History* history = nullptr) noexcept;
+
+    // picks captures, then queen promotions that don't capture (for the
+    // quiescence search, when not in check)
+    explicit MovePicker(const Board& board) noexcept;
+
+    // the next move to search, or Move::none() once every move has been picked
+    Move next() noexcept;
+
+  private:
+    const Board& board;
+    Move tt_move;
+    Move killers[2];
+    uint8_t killer_idx;
+    Move countermove;
+    const History* history;
+    Stage stage;
+    bool quiescence;
+
+    MoveList moves;
+    int scores[MoveList::capacity];
+    size_t current;
+
+    // moves the best-scored move left to current (one step of a selection sort)
+    // so a cutoff after a few moves never pays for a full sort
+    void pickBest() noexcept;
+    // whether move was already handed out by an earlier stage
+    inline bool isRepeat(Move move) const noexcept {
+      return move == tt_move || move == killers[0] || move == killers[1] || move == countermove;
+    }
+  };
+}
+
+#endif // MOVEPICK_H
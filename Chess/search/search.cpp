@@ -0,0 +1,452 @@
+#include "search.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+#include "../eval/eval.h"
+#include "movepick.h"
+#include "see.h"
+
+using namespace Search;
+
+namespace {
+  // aspiration windows start once the score has had a few plies to settle
+  constexpr int aspiration_depth = 4;
+  constexpr int aspiration_window = 25;
+  // a capture that can't lift the score to within this of alpha, even
+  // winning its victim for free, is skipped in the quiescence search
+  constexpr int delta_margin = 200;
+
+  // null move pruning searches the pass this many plies shallower (plus a
+  // ply for every null_move_divisor plies of depth left)
+  constexpr int null_move_min_depth = 3;
+  constexpr int null_move_reduction = 3;
+  constexpr int null_move_divisor = 6;
+  // late move reductions start after this many moves, this deep
+  constexpr int lmr_min_moves = 3;
+  constexpr int lmr_min_depth = 3;
+  // a quiet move is pruned at depth d if the static evaluation is more than
+  // futility_margins[d] below alpha; razoring drops straight into the
+  // quiescence search when it is razor_margins[d] below
+  constexpr int futility_margins[] = { 0, 200, 300, 500 };
+  constexpr int futility_max_depth = 3;
+  constexpr int razor_margins[] = { 0, 300, 550 };
+  constexpr int razor_max_depth = 2;
+
+  // how many plies late moves are reduced by, growing with the log of both
+  // the depth & the move number (a quiet move far down the list at a deep
+  // node is unlikely to be best, however the ordering got there)
+  inline int lmrReduction(int depth, int move_number) noexcept {
+    static const auto table = [] {
+      std::array<std::array<int8_t, 64>, 64> t{};
+      for (int d = 1; d < 64; ++d)
+        for (int m = 1; m < 64; ++m)
+          t[d][m] = static_cast<int8_t>(0.75 + std::log(d) * std::log(m) / 2.25);
+      return t;
+    }();
+    return table[std::min(depth, 63)][std::min(move_number, 63)];
+  }
+
+  // without pieces the side to move is often in zugzwang, where passing
+  // would be its best move, so a null move proves nothing
+  inline bool hasNonPawnMaterial(const Board& board) noexcept {
+    bool white = board.isWhitesMove();
+    Bitboards::bb pawns_and_king = board.getPieces((white) ? Piece::white_pawn : Piece::black_pawn)
+      | board.getPieces((white) ? Piece::white_king : Piece::black_king);
+    return board.getPieces(white) & ~pawns_and_king;
+  }
+
+  // mate scores are stored relative to the node rather than the root,
+  // so they stay correct when the position is reached at another ply
+  inline int scoreToTT(int score, int ply) noexcept {
+    if (score >= score_mate_bound) return score + ply;
+    if (score <= -score_mate_bound) return score - ply;
+    return score;
+  }
+  inline int scoreFromTT(int score, int ply) noexcept {
+    if (score >= score_mate_bound) return score - ply;
+    if (score <= -score_mate_bound) return score + ply;
+    return score;
+  }
+
+  // the material a capture takes (a pawn for en passant)
+  inline int victimValue(const Board& board, Move move) noexcept {
+    Piece::Name victim = board.getPiece(move.getToSquare());
+    return (Piece::isSquare(victim)) ? Eval::pawn_value : Eval::pieceValue(Piece::getType(victim));
+  }
+}
+
+Searcher::Searcher(TranspositionTable& tt, std::atomic<bool>& stop, int thread_id
+  , const Selectivity& selectivity) noexcept
+  : tt(tt), stop(stop), tt_stats(), pawn_table(), thread_id(thread_id), selectivity(selectivity)
+  , board(), limits(), nodes(0), stopped(false), history(), ordering_stats() {
+  for (auto& from : countermoves)
+    for (Move& move : from) move = Move::none();
+}
+
+void Searcher::clear() noexcept {
+  history.clear();
+  for (auto& from : countermoves)
+    for (Move& move : from) move = Move::none();
+  pawn_table.clear();
+}
+
+void Searcher::updateQuietOrdering(Move move, const Move* tried, int num_tried, int depth, int ply) noexcept {
+  if (killers[ply][0] != move) {
+    killers[ply][1] = killers[ply][0];
+    killers[ply][0] = move;
+  }
+  bool white = board.isWhitesMove();
+  int bonus = History::bonus(depth);
+  history.update(white, move, bonus);
+  for (int i = 0; i < num_tried; ++i) history.update(white, tried[i], -bonus);
+  if (ply > 0 && !line[ply - 1].isNone()) {
+    Move previous = line[ply - 1];
+    countermoves[previous.getFromSquare()][previous.getToSquare()] = move;
+  }
+}
+
+bool Searcher::isDraw(int ply) const noexcept {
+  int halfmove_clock = board.getHalfmoveClock();
+  if (halfmove_clock >= 100) return true;
+  // a repetition needs the same side to move, & can't reach back past
+  // the last capture or pawn move
+  int earliest = ply - halfmove_clock;
+  int i = ply - 4;
+  for (; i >= std::max(0, earliest); i -= 2) {
+    if (keys[i] == keys[ply]) return true;
+  }
+  // then on past the root, into the positions played before it
+  // (ply -1 is the last of them)
+  const std::vector<Zobrist::Key>& history = limits.history;
+  for (int h = static_cast<int>(history.size()) + i; i >= earliest && h >= 0; i -= 2, h -= 2) {
+    if (history[h] == keys[ply]) return true;
+  }
+  return false;
+}
+
+int Searcher::negamax(int alpha, int beta, int depth, int ply) {
+  pv_length[ply] = 0;
+  keys[ply] = board.getKey();
+  // the quiescence search counts (& checks for stopping at) the horizon
+  // nodes itself, so they aren't counted twice
+  if (depth <= 0 && (ply == 0 || !isDraw(ply))) return quiescence(alpha, beta, ply);
+  countNode();
+
+  if (ply > 0) {
+    if (shouldStop()) return 0;
+    if (isDraw(ply)) return score_draw;
+  }
+  if (ply >= max_ply - 1) return Eval::evaluate(board, pawn_table);
+
+  // a deep enough stored result can end the search here, except on
+  // the principal variation, where the line itself is wanted
+  bool pv_node = beta - alpha > 1;
+  Move tt_move = Move::none();
+  TranspositionTable::Entry entry;
+  if (tt.probe(board.getKey(), entry, tt_stats)) {
+    tt_move = entry.move;
+    int tt_score = scoreFromTT(entry.score, ply);
+    if (!pv_node && ply > 0 && entry.depth >= depth
+      && (entry.bound == bound_exact
+        || (entry.bound == bound_lower && tt_score >= beta)
+        || (entry.bound == bound_upper && tt_score <= alpha))) return tt_score;
+  }
+
+  bool in_check = board.isInCheck();
+  int static_eval = (in_check) ? -score_infinite : Eval::evaluate(board, pawn_table);
+
+  // razoring: far enough below alpha that only a tactic could help, so
+  // let the quiescence search look for one
+  if (selectivity.razoring && !pv_node && !in_check && depth <= razor_max_depth
+    && static_eval + razor_margins[depth] <= alpha) {
+    int score = quiescence(alpha, alpha + 1, ply);
+    if (stopped) return 0;
+    if (score <= alpha) return score;
+  }
+
+  // null move pruning: if passing still fails high in a shallower search,
+  // a real move almost certainly would too
+  if (selectivity.null_move && !pv_node && !in_check && ply > 0 && depth >= null_move_min_depth
+    && !line[ply - 1].isNone() && static_eval >= beta && hasNonPawnMaterial(board)) {
+    int reduction = null_move_reduction + depth / null_move_divisor;
+    line[ply] = Move::none();
+    Board::Undo undo = board.makeNullMove();
+    int score = -negamax(-beta, -beta + 1, depth - 1 - reduction, ply + 1);
+    board.unmakeNullMove(undo);
+    if (stopped) return 0;
+    // a mate found after passing isn't a real mate
+    if (score >= beta) return (score >= score_mate_bound) ? beta : score;
+  }
+
+  // futility pruning: at the frontier, quiet moves can't make up the gap
+  bool futile = selectivity.futility && !pv_node && !in_check && depth <= futility_max_depth
+    && !isMateScore(alpha) && static_eval + futility_margins[depth] <= alpha;
+
+  int original_alpha = alpha;
+  int best_score = -score_infinite;
+  Move best_move = Move::none();
+  int num_legal = 0;
+  // the quiet moves searched so far, to punish if a later one cuts off
+  Move quiets_tried[64];
+  int num_quiets = 0;
+
+  Move countermove = Move::none();
+  if (ply > 0 && !line[ply - 1].isNone())
+    countermove = countermoves[line[ply - 1].getFromSquare()][line[ply - 1].getToSquare()];
+  MovePicker picker(board, tt_move, killers[ply][0], killers[ply][1], countermove, &history);
+  for (Move move = picker.next(); !move.isNone(); move = picker.next()) {
+    ++num_legal;
+    bool quiet = !board.isCapture(move) && move.getSpecial() != Move::promo;
+    line[ply] = move;
+    Board::Undo undo = board.makeMove(move);
+    bool gives_check = board.isInCheck();
+    if (futile && quiet && num_legal > 1 && !gives_check) {
+      board.unmakeMove(move, undo);
+      continue;
+    }
+
+    // late quiet moves are searched shallower first, & only at full
+    // depth if they turn out better than alpha after all
+    int reduction = 0;
+    if (selectivity.late_move_reductions && quiet && num_legal > lmr_min_moves
+      && depth >= lmr_min_depth && !in_check && !gives_check) {
+      reduction = lmrReduction(depth, num_legal);
+      // moves that have cut off often elsewhere are reduced less
+      reduction -= history.get(!board.isWhitesMove(), move) * 2 / History::max_score;
+      reduction = std::clamp(reduction, 0, depth - 2);
+    }
+    // principal variation search: once a first move has been searched, the
+    // rest only have to be shown worse, which a null window does cheaply;
+    // one that isn't gets searched again with the full window
+    int score;
+    if (num_legal == 1) score = -negamax(-beta, -alpha, depth - 1, ply + 1);
+    else {
+      score = -negamax(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
+      if (score > alpha && reduction && !stopped)
+        score = -negamax(-alpha - 1, -alpha, depth - 1, ply + 1);
+      if (score > alpha && score < beta && !stopped)
+        score = -negamax(-beta, -alpha, depth - 1, ply + 1);
+    }
+    board.unmakeMove(move, undo);
+    if (stopped) return 0;
+
+    if (score > best_score) {
+      best_score = score;
+      best_move = move;
+      if (score > alpha) {
+        alpha = score;
+        pv[ply][0] = move;
+        std::copy(pv[ply + 1], pv[ply + 1] + pv_length[ply + 1], pv[ply] + 1);
+        pv_length[ply] = pv_length[ply + 1] + 1;
+        if (alpha >= beta) {
+          ++ordering_stats.cutoffs;
+          if (num_legal == 1) ++ordering_stats.first_move_cutoffs;
+          if (quiet) updateQuietOrdering(move, quiets_tried, num_quiets, depth, ply);
+          break;
+        }
+      }
+    }
+    if (quiet && num_quiets < 64) quiets_tried[num_quiets++] = move;
+  }
+
+  if (!num_legal) return (in_check) ? -score_mate + ply : score_draw;
+
+  // a fail low has no best move worth remembering
+  Bound bound = (best_score >= beta) ? bound_lower
+    : ((best_score > original_alpha) ? bound_exact : bound_upper);
+  tt.store(board.getKey(), (bound == bound_upper) ? Move::none() : best_move
+    , scoreToTT(best_score, ply), depth, bound, tt_stats);
+  return best_score;
+}
+
+int Searcher::quiescence(int alpha, int beta, int ply) {
+  pv_length[ply] = 0;
+  countNode();
+  if (shouldStop()) return 0;
+  if (ply >= max_ply - 1) return Eval::evaluate(board, pawn_table);
+
+  // in check there is no standing pat: every evasion has to be tried
+  bool in_check = board.isInCheck();
+  int best_score = -score_infinite;
+  int stand_pat = 0;
+  if (!in_check) {
+    stand_pat = Eval::evaluate(board, pawn_table);
+    if (stand_pat >= beta) return stand_pat;
+    if (stand_pat > alpha) alpha = stand_pat;
+    best_score = stand_pat;
+  }
+
+  int num_legal = 0;
+  MovePicker picker = (in_check) ? MovePicker(board, Move::none()) : MovePicker(board);
+  for (Move move = picker.next(); !move.isNone(); move = picker.next()) {
+    ++num_legal;
+    if (!in_check && board.isCapture(move)) {
+      if (move.getSpecial() != Move::promo
+        && stand_pat + victimValue(board, move) + delta_margin <= alpha) continue;
+      // losing exchanges can't help when standing pat is already an option
+      if (losesMaterial(board, move)) continue;
+    }
+    Board::Undo undo = board.makeMove(move);
+    int score = -quiescence(-beta, -alpha, ply + 1);
+    board.unmakeMove(move, undo);
+    if (stopped) return 0;
+
+    if (score > best_score) {
+      best_score = score;
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta) break;
+      }
+    }
+  }
+
+  if (in_check && !num_legal) return -score_mate + ply;
+  return best_score;
+}
+
+Result Searcher::search(const Board& root, const Limits& search_limits
+  , const IterationCallback& on_iteration) {
+  auto start = std::chrono::steady_clock::now();
+  board = root;
+  limits = search_limits;
+  nodes.store(0, std::memory_order_relaxed);
+  stopped = false;
+  tt_stats = TranspositionTable::Stats();
+  pawn_table.resetStats();
+  ordering_stats = OrderingStats();
+  // killers are only good for the position they were found in; history
+  // & countermoves are looser, so they carry over to this Searcher's next
+  // search (until clear()), which is worth something when the caller keeps
+  // it for a game or a batch, as Threads & Batch::analyse do
+  for (auto& slots : killers) slots[0] = slots[1] = Move::none();
+
+  Result result;
+  int score = 0;
+  bool forced = limits.time && limits.time->isLimited() && root.countLegalMoves() == 1;
+  for (int depth = 1 + (thread_id & 1); depth <= limits.depth && depth < max_ply; ++depth) {
+    int delta = aspiration_window;
+    int alpha = -score_infinite, beta = score_infinite;
+    if (depth >= aspiration_depth) {
+      alpha = std::max(score - delta, -score_infinite);
+      beta = std::min(score + delta, score_infinite);
+    }
+    // widen whichever side the score fell out of until it lands inside
+    while (true) {
+      int window_score = searchRoot(alpha, beta, depth);
+      if (stopped) break;
+      if (window_score <= alpha) {
+        alpha = std::max(window_score - delta, -score_infinite);
+        if (limits.time) limits.time->onFailLow();
+      }
+      else if (window_score >= beta) beta = std::min(window_score + delta, score_infinite);
+      else {
+        score = window_score;
+        break;
+      }
+      delta *= 2;
+    }
+    if (stopped) break;
+
+    result.depth = depth;
+    result.score = score;
+    result.pv.assign(pv[0], pv[0] + pv_length[0]);
+    result.best_move = (pv_length[0]) ? pv[0][0] : Move::none();
+    if (on_iteration) {
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      result.nodes = getNodes();
+      result.seconds = elapsed.count();
+      on_iteration(result);
+    }
+    // nothing left to find once there are no moves or a mate is proven
+    if (!pv_length[0] || isMateScore(score)) break;
+    if (limits.time) {
+      // with only one legal move there is nothing to think about
+      if (forced) break;
+      if (!limits.time->onIteration(result.best_move, score)) break;
+    }
+  }
+
+  // stopped before the first iteration finished: any legal move beats none
+  if (result.best_move.isNone()) {
+    MoveList moves;
+    root.getAllMoves(moves);
+    if (!moves.empty()) {
+      result.best_move = moves[0];
+      result.pv.assign(1, moves[0]);
+    }
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  result.nodes = getNodes();
+  result.seconds = elapsed.count();
+  return result;
+}
+
+Threads::Threads(TranspositionTable& tt, std::atomic<bool>& stop, const Selectivity& selectivity)
+  : tt(tt), stop(stop), helpers_stop(false), selectivity(selectivity), searchers() {}
+
+Result Threads::search(const Board& board, const Limits& limits, int num_threads
+  , const IterationCallback& on_iteration) {
+  tt.newSearch();
+  num_threads = std::max(num_threads, 1);
+  if (searchers.empty()) searchers.push_back(std::make_unique<Searcher>(tt, stop, 0, selectivity));
+  for (int id = static_cast<int>(searchers.size()); id < num_threads; ++id) {
+    searchers.push_back(std::make_unique<Searcher>(tt, helpers_stop, id, selectivity));
+  }
+  helpers_stop.store(false, std::memory_order_relaxed);
+
+  // helpers stop at the same depth, but otherwise search until the main
+  // thread is done: the node limit & the clock are only the main thread's
+  std::vector<Result> results(num_threads);
+  std::vector<std::thread> helpers;
+  Limits helper_limits;
+  helper_limits.depth = limits.depth;
+  helper_limits.history = limits.history;
+  for (int id = 1; id < num_threads; ++id) {
+    helpers.emplace_back([&, id]() { results[id] = searchers[id]->search(board, helper_limits); });
+  }
+  results[0] = searchers[0]->search(board, limits, on_iteration);
+  helpers_stop.store(true, std::memory_order_relaxed);
+  for (std::thread& helper : helpers) helper.join();
+
+  // a helper that finished a deeper iteration knows more than the main thread
+  Result result = std::move(results[0]);
+  result.thread_depths.assign(1, result.depth);
+  for (int id = 1; id < num_threads; ++id) {
+    result.thread_depths.push_back(results[id].depth);
+    if (results[id].depth > result.depth && !results[id].best_move.isNone()) {
+      result.best_move = results[id].best_move;
+      result.score = results[id].score;
+      result.depth = results[id].depth;
+      result.pv = std::move(results[id].pv);
+    }
+  }
+  result.nodes = 0;
+  for (int id = 0; id < num_threads; ++id) {
+    result.nodes += searchers[id]->getNodes();
+    result.pawn_stats += searchers[id]->getPawnStats();
+    result.ordering += searchers[id]->getOrderingStats();
+  }
+  return result;
+}
+
+void Threads::clear() noexcept {
+  for (const std::unique_ptr<Searcher>& searcher : searchers) searcher->clear();
+}
+
+Result Search::search(const Board& board, const Limits& limits, TranspositionTable& tt
+  , std::atomic<bool>& stop, int num_threads, const Selectivity& selectivity
+  , const IterationCallback& on_iteration) {
+  Threads threads(tt, stop, selectivity);
+  return threads.search(board, limits, num_threads, on_iteration);
+}
+
+Result Search::search(const Board& board, const Limits& limits, TranspositionTable& tt) {
+  std::atomic<bool> stop(false);
+  return search(board, limits, tt, stop, 1);
+}
@@ -0,0 +1,247 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+// defines the search: a depth-first negamax alpha-beta search over Board
+// using make/unmake, deepened one ply at a time (iterative deepening).
+// each iteration starts with a narrow window around the last score
+// (an aspiration window) & widens it only if the score falls outside,
+// & the best line found is tracked in a triangular PV table. at the horizon
+// a quiescence search plays out captures & promotions until the position
+// is quiet, so the evaluation is never taken in the middle of an exchange.
+// only the first move at a node gets the full window; the rest are tested
+// against a null window first (principal variation search), & the nodes
+// this leaves off the principal variation are where selectivity applies:
+// moves that are unlikely to matter are searched less, with null move pruning,
+// late move reductions, futility pruning & razoring (see Selectivity).
+// several Searchers can run at once on their own threads & Boards, sharing
+// only the transposition table & a stop flag (Lazy SMP): they race through
+// the same tree & speed each other up through the entries they store
+//
+// For more info, read https://www.chessprogramming.org/Alpha-Beta,
+// https://www.chessprogramming.org/Iterative_Deepening
+// https://www.chessprogramming.org/Aspiration_Windows
+// https://www.chessprogramming.org/Quiescence_Search
+// https://www.chessprogramming.org/Principal_Variation_Search
+// https://www.chessprogramming.org/Selectivity
+// and https://www.chessprogramming.org/Lazy_SMP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "../board/board.h"
+#include "../eval/pawns.h"
+#include "movepick.h"
+#include "timeman.h"
+#include "tt.h"
+
+namespace Search {
+  constexpr int max_ply = 128;
+  constexpr int score_infinite = 32001;
+  // a mate found n plies from the root scores score_mate - n
+  constexpr int score_mate = 32000;
+  constexpr int score_mate_bound = score_mate - max_ply;
+  constexpr int score_draw = 0;
+
+  constexpr inline bool isMateScore(int score) noexcept {
+    return score >= score_mate_bound || score <= -score_mate_bound;
+  }
+
+  // when to stop searching
+  struct Limits {
+    // the deepest iteration to run
+    int depth = max_ply - 1;
+    // stop after (roughly) this many nodes, 0 for no limit
+    uint64_t nodes = 0;
+    // stop by the clock, or nullptr for no time limit (owned by the caller,
+    // who may start it later, e.g. on ponderhit); only the main thread reads it
+    TimeManager* time = nullptr;
+    // the keys of the positions played before the root, oldest first,
+    // back to the last capture or pawn move (the root's own key left out),
+    // so the search sees repetitions of the game & not just of its own lines
+    std::vector<Zobrist::Key> history;
+  };
+
+  // the selective search techniques, each of which can be turned off
+  // to measure what it is worth (all are on by default)
+  struct Selectivity {
+    // skip the node if passing the turn still fails high
+    bool null_move = true;
+    // search late quiet moves shallower first
+    bool late_move_reductions = true;
+    // skip quiet moves near the leaves that can't reach alpha
+    bool futility = true;
+    // drop into the quiescence search near the leaves when far below alpha
+    bool razoring = true;
+  };
+
+  // how well moves were ordered in the main search (not quiescence):
+  // with perfect ordering every cutoff comes from the first move searched
+  struct OrderingStats {
+    uint64_t cutoffs = 0;
+    uint64_t first_move_cutoffs = 0;
+
+    inline double firstMoveCutoffRate() const noexcept {
+      return (cutoffs) ? static_cast<double>(first_move_cutoffs) / cutoffs : 0;
+    }
+    inline OrderingStats& operator+=(const OrderingStats& rhs) noexcept {
+      cutoffs += rhs.cutoffs;
+      first_move_cutoffs += rhs.first_move_cutoffs;
+      return *this;
+    }
+  };
+
+  struct Result {
+    // Move::none() if the root has no legal moves
+    Move best_move = Move::none();
+    int score = 0;
+    // the last iteration that finished
+    int depth = 0;
+    uint64_t nodes = 0;
+    double seconds = 0;
+    // the principal variation, starting with best_move
+    std::vector<Move> pv;
+    // how often the threads' pawn hash tables had the pawn structure cached
+    Eval::PawnTable::Stats pawn_stats;
+    // summed over every thread
+    OrderingStats ordering;
+    // the last iteration each thread finished, the main thread's first
+    std::vector<int> thread_depths;
+
+    inline double nodesPerSecond() const noexcept {
+      return (seconds > 0) ? nodes / seconds : 0;
+    }
+  };
+
+  // called by the main thread after each finished iteration, with the
+  // result so far (nodes & seconds are the main thread's, up to then)
+  typedef std::function<void(const Result&)> IterationCallback;
+
+  // searches one position at a time on its own copy of the Board
+  class Searcher {
+  public:
+    // tt & stop are shared with whoever else uses them; setting stop
+    // ends the search as soon as the searcher notices
+    // thread_id 0 is the main thread; helpers with odd ids start each
+    // iteration a ply deeper, so the threads spread over more of the tree
+    Searcher(TranspositionTable& tt, std::atomic<bool>& stop, int thread_id = 0
+      , const Selectivity& selectivity = Selectivity()) noexcept;
+
+    // runs iterative deepening on board until limits or stop are hit
+    // returns the result of the deepest finished iteration
+    Result search(const Board& board, const Limits& limits
+      , const IterationCallback& on_iteration = nullptr);
+    // forgets the history, countermoves & pawn structures learned so far,
+    // which otherwise carry over from one search to the next
+    void clear() noexcept;
+
+    // the stats are those of the last search
+    // safe to read from other threads while the search runs
+    inline uint64_t getNodes() const noexcept { return nodes.load(std::memory_order_relaxed); }
+    inline const TranspositionTable::Stats& getTTStats() const noexcept { return tt_stats; }
+    inline const Eval::PawnTable::Stats& getPawnStats() const noexcept { return pawn_table.getStats(); }
+    inline const OrderingStats& getOrderingStats() const noexcept { return ordering_stats; }
+
+  private:
+    TranspositionTable& tt;
+    std::atomic<bool>& stop;
+    TranspositionTable::Stats tt_stats;
+    // each thread has its own pawn table, as it is small & probed every leaf
+    Eval::PawnTable pawn_table;
+
+    int thread_id;
+    Selectivity selectivity;
+    Board board;
+    Limits limits;
+    // only this thread writes its counter, so it needs no atomic increment;
+    // it is atomic only so others can read it mid-search
+    std::atomic<uint64_t> nodes;
+    bool stopped;
+
+    // keys of the positions on the current line, for spotting repetitions
+    Zobrist::Key keys[max_ply + 1];
+    // the move played at each ply of the current line
+    Move line[max_ply + 1];
+
+    // move ordering tables, fed by the quiet moves that cause cutoffs
+    // killers[ply] holds the last two at that ply
+    Move killers[max_ply][2];
+    History history;
+    // indexed by the from & to squares of the move being answered
+    Move countermoves[64][64];
+    OrderingStats ordering_stats;
+
+    // pv[ply] holds the best line found from ply, pv_length[ply] moves long
+    Move pv[max_ply][max_ply];
+    int pv_length[max_ply];
+
+    int negamax(int alpha, int beta, int depth, int ply);
+    // searches only captures & promotions (every move when in check),
+    // letting the side to move stand pat on the static evaluation
+    int quiescence(int alpha, int beta, int ply);
+    // searches the root with the window (alpha, beta)
+    inline int searchRoot(int alpha, int beta, int depth) { return negamax(alpha, beta, depth, 0); }
+
+    // rewards the quiet move that cut off at ply & punishes the quiets
+    // tried before it
+    void updateQuietOrdering(Move move, const Move* tried, int num_tried, int depth, int ply) noexcept;
+    // whether the position at ply repeats one earlier on the line or in the
+    // game before the root, or the 50 move rule has run out
+    bool isDraw(int ply) const noexcept;
+    // checks the node limit, the stop flag & the clock
+    // (only every so many nodes, as the flag is shared & the clock is a syscall)
+    inline bool shouldStop() noexcept {
+      uint64_t count = getNodes();
+      if ((count & 0xfff) == 0) {
+        if (stop.load(std::memory_order_relaxed)
+          || (limits.nodes && count >= limits.nodes)) stopped = true;
+      }
+      if (limits.time && count >= limits.time->nextCheck() && limits.time->outOfTime(count)) stopped = true;
+      return stopped;
+    }
+    inline void countNode() noexcept {
+      nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+  };
+
+  // the Searchers of a Lazy SMP search, kept from one search to the next
+  // so their pawn tables & move ordering tables stay warm over a game
+  class Threads {
+  public:
+    // tt & stop are shared as with Searcher, & stop only ends the main thread
+    Threads(TranspositionTable& tt, std::atomic<bool>& stop
+      , const Selectivity& selectivity = Selectivity());
+
+    // runs a Lazy SMP search on num_threads threads until limits are hit or
+    // stop is set, & returns the deepest finished result with every thread's nodes
+    // the helper threads stop at limits.depth too, but otherwise run until the
+    // main thread finishes, so the node limit only counts the main thread's nodes
+    Result search(const Board& board, const Limits& limits, int num_threads = 1
+      , const IterationCallback& on_iteration = nullptr);
+    // clears every Searcher, e.g. for a new game
+    void clear() noexcept;
+
+  private:
+    TranspositionTable& tt;
+    std::atomic<bool>& stop;
+    // ends the helpers once the main thread is done
+    std::atomic<bool> helpers_stop;
+    Selectivity selectivity;
+    // each Searcher is allocated on its own, so no two threads' counters
+    // or PV tables share a cache line; there are as many as the most
+    // threads searched with so far
+    std::vector<std::unique_ptr<Searcher>> searchers;
+  };
+
+  // runs a Lazy SMP search with Searchers of its own (see Threads::search),
+  // so nothing learned is kept for the next search but the tt
+  Result search(const Board& board, const Limits& limits, TranspositionTable& tt
+    , std::atomic<bool>& stop, int num_threads = 1, const Selectivity& selectivity = Selectivity()
+    , const IterationCallback& on_iteration = nullptr);
+  // runs a single-threaded search with its own stop flag
+  Result search(const Board& board, const Limits& limits, TranspositionTable& tt);
+}
+
+#endif // SEARCH_H
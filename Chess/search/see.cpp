@@ -0,0 +1,114 @@
+#include "see.h"
+
+#include <algorithm>
+
+#include "../eval/eval.h"
+
+using namespace Bitboards;
+
+namespace {
+  // the piece types from cheapest to dearest, the order attackers are tried in
+  constexpr Piece::Type by_value[6] = {
+    Piece::pawn, Piece::knight, Piece::bishop, Piece::rook, Piece::queen, Piece::king,
+  };
+
+  // the pieces of type, of both colors
+  inline bb piecesOfType(const Board& board, Piece::Type type) noexcept {
+    return board.getPieces(Piece::makePiece(type, true)) | board.getPieces(Piece::makePiece(type, false));
+  }
+}
+
+bb Search::attackersTo(const Board& board, int idx, bb occupied) noexcept {
+  // a piece on idx attacks exactly the squares its kind attacks it from
+  bb square = idxToBoard(idx);
+  bb empty = ~occupied;
+  bb queens = piecesOfType(board, Piece::queen);
+  return (Movegen::genPawnThreatsS(square) & board.getPieces(Piece::white_pawn))
+    | (Movegen::genPawnThreatsN(square) & board.getPieces(Piece::black_pawn))
+    | (Movegen::genKnightThreats(square) & piecesOfType(board, Piece::knight))
+    | (Movegen::genBishopThreats(square, empty) & (piecesOfType(board, Piece::bishop) | queens))
+    | (Movegen::genRookThreats(square, empty) & (piecesOfType(board, Piece::rook) | queens))
+    | (Movegen::genKingThreats(square) & piecesOfType(board, Piece::king));
+}
+
+int Search::see(const Board& board, Move move) noexcept {
+  int from = move.getFromSquare();
+  int to = move.getToSquare();
+  bb target = idxToBoard(to);
+  bb occupied = board.getPieces(true) | board.getPieces(false);
+
+  Piece::Type attacker = Piece::getType(board.getPiece(from));
+  Piece::Name victim = board.getPiece(to);
+  int gain[32];
+  if (!Piece::isSquare(victim)) gain[0] = Eval::pieceValue(Piece::getType(victim));
+  else if (attacker == Piece::pawn && to == board.getEnPassantSquare()) {
+    // the pawn taken en passant sits behind the target square
+    gain[0] = Eval::pawn_value;
+    occupied ^= idxToBoard(to + ((board.isWhitesMove()) ? Indexing::south : Indexing::north));
+  }
+  else gain[0] = 0;
+  if (move.getSpecial() == Move::promo) {
+    attacker = move.getPromoPieceType();
+    gain[0] += Eval::pieceValue(attacker) - Eval::pawn_value;
+  }
+
+  bb bishoplike = piecesOfType(board, Piece::bishop) | piecesOfType(board, Piece::queen);
+  bb rooklike = piecesOfType(board, Piece::rook) | piecesOfType(board, Piece::queen);
+  occupied ^= idxToBoard(from);
+  bb attackers = attackersTo(board, to, occupied) & occupied;
+  int on_square = Eval::pieceValue(attacker);
+  bool white = !board.isWhitesMove();
+
+  int depth = 0;
+  while (true) {
+    bb mine = attackers & board.getPieces(white);
+    if (!mine) break;
+    Piece::Type type = Piece::king;
+    bb candidates = 0;
+    for (Piece::Type t : by_value) {
+      candidates = mine & piecesOfType(board, t);
+      if (candidates) {
+        type = t;
+        break;
+      }
+    }
+    // the king can only take last, when nothing can take it back
+    if (type == Piece::king && (attackers & board.getPieces(!white))) break;
+
+    ++depth;
+    gain[depth] = on_square - gain[depth - 1];
+    // this capture loses even if nothing takes back, so it isn't played
+    if (std::max(-gain[depth - 1], gain[depth]) < 0) {
+      --depth;
+      break;
+    }
+
+    occupied ^= candidates & -candidates;
+    // lifting a piece can uncover a slider behind it on the same line
+    if (type == Piece::pawn || type == Piece::bishop || type == Piece::queen)
+      attackers |= fillBishopAttacks(target, ~occupied) & bishoplike;
+    if (type == Piece::rook || type == Piece::queen)
+      attackers |= fillRookAttacks(target, ~occupied) & rooklike;
+    attackers &= occupied;
+
+    on_square = Eval::pieceValue(type);
+    white = !white;
+    if (depth == 31) break;
+  }
+
+  // each side only recaptures when that beats stopping
+  while (depth > 0) {
+    gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    --depth;
+  }
+  return gain[0];
+}
+
+bool Search::losesMaterial(const Board& board, Move move) noexcept {
+  Piece::Name victim = board.getPiece(move.getToSquare());
+  int attacker_value = Eval::pieceValue(Piece::getType(board.getPiece(move.getFromSquare())));
+  // empty for en passant, where a pawn takes a pawn
+  int victim_value = (Piece::isSquare(victim)) ? Eval::pawn_value : Eval::pieceValue(Piece::getType(victim));
+  if (victim_value >= attacker_value && move.getSpecial() != Move::promo) return false;
+  return see(board, move) < 0;
+}
@@ -0,0 +1,29 @@
+#ifndef SEE_H
+#define SEE_H
+
+// defines static exchange evaluation: how much material a capture wins or
+// loses once both sides have recaptured on its square with their cheapest
+// pieces for as long as it pays them to.
+// it works on bitboards of the attackers alone & never touches the board,
+// so it is cheap enough to run on every capture for ordering & pruning.
+// pins & checks are ignored, as is promoting on a recapture
+//
+// For more info, read https://www.chessprogramming.org/Static_Exchange_Evaluation
+// and https://www.chessprogramming.org/SEE_-_The_Swap_Algorithm
+
+#include "../board/board.h"
+
+namespace Search {
+  // every piece of either color attacking square idx, given the occupancy
+  Bitboards::bb attackersTo(const Board& board, int idx, Bitboards::bb occupied) noexcept;
+
+  // the material the side to move gains by playing move, in centipawns
+  // (negative if the exchange loses material; 0 for an even trade or a
+  // quiet move onto a safe square)
+  int see(const Board& board, Move move) noexcept;
+  // whether see(board, move) < 0, skipping the exchange when the piece
+  // taken is worth at least as much as the piece taking it
+  bool losesMaterial(const Board& board, Move move) noexcept;
+}
+
+#endif // SEE_H
@@ -0,0 +1,578 @@
+#include "../eval/eval.h"
+#include "movepick.h"
+#include "search.h"
+#include "see.h"
+#include "timeman.h"
+#include "tt.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace Search;
+using std::cout, std::endl;
+
+int main() {
+  TranspositionTable::Stats stats;
+  TranspositionTable::Entry entry;
+
+  cout << "Testing TranspositionTable...\n- Sizing...";
+  {
+    TranspositionTable tt(1);
+    if (tt.getSizeBytes() != (1 << 20))
+      cout << "[FAIL] Expected 1048576 bytes, got " << tt.getSizeBytes() << endl;
+    else {
+      tt.resize(3);
+      if (tt.getSizeBytes() != (2 << 20))
+        cout << "[FAIL] Expected a power-of-two size of 2097152 bytes, got " << tt.getSizeBytes() << endl;
+      else cout << "[PASS]" << endl;
+    }
+  }
+
+  TranspositionTable tt(1);
+  cout << "- Store then probe...";
+  {
+    Move move(12, 28, Move::en_passant);
+    tt.store(0x123456789abcdef0, move, -321, 7, bound_lower, stats);
+    if (!tt.probe(0x123456789abcdef0, entry, stats))
+      cout << "[FAIL] Stored entry not found" << endl;
+    else if (entry.move != move || entry.score != -321 || entry.depth != 7 || entry.bound != bound_lower)
+      cout << "[FAIL] Entry came back different from what was stored" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Probe of a missing key...";
+  if (tt.probe(0x0fedcba987654321, entry, stats)) cout << "[FAIL] Found an entry never stored" << endl;
+  else cout << "[PASS]" << endl;
+
+  cout << "- Same position keeps its best move...";
+  {
+    tt.store(0x1111, Move(8, 16), 50, 4, bound_exact, stats);
+    tt.store(0x1111, Move::fromBits(0), 60, 5, bound_upper, stats);
+    if (!tt.probe(0x1111, entry, stats) || entry.move != Move(8, 16) || entry.score != 60)
+      cout << "[FAIL]" << endl;
+    else cout << "[PASS]" << endl;
+  }
+
+  cout << "- Full bucket evicts & counts...";
+  {
+    tt.clear();
+    TranspositionTable::Stats bucket_stats;
+    size_t stride = tt.getNumBuckets();  // keys that map to the same bucket
+    for (uint64_t i = 1; i <= 5; ++i)
+      tt.store(i * stride, Move(0, 1), 0, static_cast<int>(i), bound_exact, bucket_stats);
+    bool found_deepest = tt.probe(5 * stride, entry, bucket_stats);
+    bool found_shallowest = tt.probe(1 * stride, entry, bucket_stats);
+    tt.probe(6 * stride, entry, bucket_stats);
+    if (!found_deepest || found_shallowest)
+      cout << "[FAIL] Replaced the wrong slot" << endl;
+    else if (bucket_stats.overwrites != 1 || bucket_stats.collisions != 2 || bucket_stats.hits != 1)
+      cout << "[FAIL] Wrong counters" << endl;
+    else cout << "[PASS]" << endl;
+  }
+
+  cout << "- Concurrent writers never yield torn entries...";
+  {
+    tt.clear();
+    // every thread stores a score derived from the key & a depth equal to
+    // its move's destination, so any entry that verifies but mixes the
+    // halves of two writes is a torn read
+    auto scoreFor = [](uint64_t key) { return static_cast<int>(key % 20000) - 10000; };
+    const uint64_t num_keys = 1 << 12;
+    std::vector<std::thread> threads;
+    std::vector<int> torn(4, 0);
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&, t]() {
+        TranspositionTable::Stats local;
+        TranspositionTable::Entry e;
+        for (int round = 0; round < 50; ++round) {
+          for (uint64_t k = 1; k <= num_keys; ++k) {
+            uint64_t key = k * 0x9e3779b97f4a7c15;
+            // (from t + 1, since a1a1 would read as "no move" & keep the old one)
+            tt.store(key, Move(t + 1, round % 64), scoreFor(key), round % 64, bound_exact, local);
+            if (tt.probe(key, e, local)
+              && (e.score != scoreFor(key) || e.depth != e.move.getToSquare())) ++torn[t];
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+    int total_torn = torn[0] + torn[1] + torn[2] + torn[3];
+    if (total_torn) cout << "[FAIL] " << total_torn << " torn entries" << endl;
+    else cout << "[PASS]" << endl;
+  }
+
+  cout << "Testing MovePicker...\n- Picks every legal move exactly once...";
+  {
+    const char* fens[] = {
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      "8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1",
+    };
+    auto byBits = [](Move lhs, Move rhs) { return lhs.getBits() < rhs.getBits(); };
+    bool passing = true;
+    for (const char* fen : fens) {
+      Board board;
+      board.setUp(fen);
+      std::vector<Move> legal = board.getAllMoves();
+      std::sort(legal.begin(), legal.end(), byBits);
+      // try a legal table move, killers & countermove, then ones that can't be legal here
+      Move hints[][4] = {
+        { legal.front(), legal.back(), legal[legal.size() / 2], legal[legal.size() / 3] },
+        { Move(0, 63), Move(1, 62), Move(2, 61), Move(3, 60) },
+      };
+      History history;
+      for (Move move : legal) history.update(board.isWhitesMove(), move, move.getBits() % 100 - 50);
+      for (Move* hint : hints) {
+        MovePicker picker(board, hint[0], hint[1], hint[2], hint[3], &history);
+        std::vector<Move> picked;
+        for (Move move = picker.next(); !move.isNone(); move = picker.next()) picked.push_back(move);
+        std::sort(picked.begin(), picked.end(), byBits);
+        if (picked != legal) passing = false;
+      }
+    }
+    if (passing) cout << "[PASS]" << endl;
+    else cout << "[FAIL] Picked moves differ from the legal moves" << endl;
+  }
+  cout << "- Table move first, then captures by MVV-LVA, then killers...";
+  {
+    Board board;
+    // both cxd5 & Rxd5 take the queen, but the pawn is the cheaper attacker
+    board.setUp("4k3/8/4p3/3q4/2P1n3/8/8/3RK3 w - - 0 1");
+    Move tt_move(Indexing::e + Indexing::r1, Indexing::e + Indexing::r2);
+    Move killer(Indexing::d + Indexing::r1, Indexing::a + Indexing::r1);
+    MovePicker picker(board, tt_move, killer);
+    std::vector<Move> picked;
+    for (Move move = picker.next(); !move.isNone(); move = picker.next()) picked.push_back(move);
+    Move cxd5(Indexing::c + Indexing::r4, Indexing::d + Indexing::r5);
+    Move rxd5(Indexing::d + Indexing::r1, Indexing::d + Indexing::r5);
+    if (picked.size() < 4 || picked[0] != tt_move)
+      cout << "[FAIL] Table move was not picked first" << endl;
+    else if (picked[1] != cxd5 || picked[2] != rxd5)
+      cout << "[FAIL] Captures were not in MVV-LVA order" << endl;
+    else if (picked[3] != killer)
+      cout << "[FAIL] Killer did not follow the captures" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Countermove after killers, then quiets by history...";
+  {
+    Board board;
+    board.setUp("4k3/8/8/8/8/8/8/R3K3 w Q - 0 1");
+    Move killer(Indexing::a + Indexing::r1, Indexing::a + Indexing::r8);
+    Move countermove(Indexing::a + Indexing::r1, Indexing::a + Indexing::r7);
+    Move favourite(Indexing::e + Indexing::r1, Indexing::d + Indexing::r2);
+    Move runner_up(Indexing::a + Indexing::r1, Indexing::b + Indexing::r1);
+    History history;
+    history.update(true, favourite, History::bonus(8));
+    history.update(true, runner_up, History::bonus(4));
+    history.update(true, Move(Indexing::a + Indexing::r1, Indexing::c + Indexing::r1), -History::bonus(4));
+    MovePicker picker(board, Move::none(), killer, Move::none(), countermove, &history);
+    std::vector<Move> picked;
+    for (Move move = picker.next(); !move.isNone(); move = picker.next()) picked.push_back(move);
+    if (picked.size() < 4 || picked[0] != killer || picked[1] != countermove)
+      cout << "[FAIL] Expected the killer, then the countermove" << endl;
+    else if (picked[2] != favourite || picked[3] != runner_up)
+      cout << "[FAIL] Quiets were not in history order" << endl;
+    else if (picked.back() != Move(Indexing::a + Indexing::r1, Indexing::c + Indexing::r1))
+      cout << "[FAIL] A move with negative history was not picked last" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Quiescence picks only captures & promotions...";
+  {
+    // a7 can promote (4 ways, but only a8=Q counts), Rxh5 is the only capture
+    Board board;
+    board.setUp("4k3/P7/8/7p/8/8/8/4K2R w K - 0 1");
+    MovePicker picker(board);
+    std::vector<Move> picked;
+    for (Move move = picker.next(); !move.isNone(); move = picker.next()) picked.push_back(move);
+    Move rxh5(Indexing::h + Indexing::r1, Indexing::h + Indexing::r5);
+    if (picked.size() != 2) cout << "[FAIL] Expected 2 moves, got " << picked.size() << endl;
+    else if (picked[0] != rxh5 || picked[1].getSpecial() != Move::promo
+      || picked[1].getPromoType() != Move::queen)
+      cout << "[FAIL] Expected the capture, then the queen promotion" << endl;
+    else cout << "[PASS]" << endl;
+  }
+
+  cout << "Testing SEE...\n- Exchanges...";
+  {
+    struct Case {
+      const char* fen;
+      Move move;
+      int expected;
+    };
+    using namespace Indexing;
+    const Case cases[] = {
+      // an undefended pawn
+      { "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", Move(e + r1, e + r5), Eval::pawn_value },
+      // the knight is lost for a pawn, however the rest of the exchange goes
+      { "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", Move(d + r3, e + r5)
+        , Eval::pawn_value - Eval::knight_value },
+      // the second rook only joins in once the first has gone (x-ray)
+      { "3r2k1/8/8/3p4/8/8/3R4/3R2K1 w - - 0 1", Move(d + r2, d + r5), Eval::pawn_value },
+      // an even trade
+      { "4k3/8/3p4/2p5/8/8/8/2R1K3 w - - 0 1", Move(c + r1, c + r5), Eval::pawn_value - Eval::rook_value },
+      // en passant onto a square nothing defends
+      { "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", Move(e + r5, d + r6), Eval::pawn_value },
+    };
+    bool passing = true;
+    for (const Case& test : cases) {
+      Board board;
+      board.setUp(test.fen);
+      int score = see(board, test.move);
+      if (score != test.expected) {
+        cout << "[FAIL] " << test.move.toUCI() << " in " << test.fen << ": expected "
+          << test.expected << ", got " << score << endl;
+        passing = false;
+      }
+    }
+    if (passing) cout << "[PASS]" << endl;
+  }
+
+  cout << "Testing TimeManager...\n- Budgets...";
+  {
+    TimeManager::Clock sudden_death, increment, fixed;
+    sudden_death.time_ms = 60000;
+    increment.time_ms = 60000;
+    increment.increment_ms = 1000;
+    fixed.movetime_ms = 500;
+    TimeManager a(sudden_death), b(increment), c(fixed), none;
+    if (!(0 < a.getSoftMs() && a.getSoftMs() < a.getHardMs() && a.getHardMs() < sudden_death.time_ms / 2))
+      cout << "[FAIL] Expected 0 < soft < hard < half the clock, got " << a.getSoftMs() << " & " << a.getHardMs() << endl;
+    else if (b.getSoftMs() <= a.getSoftMs())
+      cout << "[FAIL] An increment did not add to the budget" << endl;
+    else if (c.getSoftMs() != c.getHardMs() || c.getHardMs() > fixed.movetime_ms)
+      cout << "[FAIL] A fixed movetime should be both budgets, got " << c.getSoftMs() << " & " << c.getHardMs() << endl;
+    else if (none.isLimited()) cout << "[FAIL] No clock should mean no limit" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Unsettled searches get more time...";
+  {
+    TimeManager::Clock clock;
+    clock.time_ms = 60000;
+    TimeManager steady(clock), unstable(clock), failing(clock);
+    Move first(Indexing::e + Indexing::r2, Indexing::e + Indexing::r4);
+    Move second(Indexing::d + Indexing::r2, Indexing::d + Indexing::r4);
+    for (int i = 0; i < 4; ++i) {
+      steady.onIteration(first, 20);
+      unstable.onIteration((i & 1) ? first : second, 20);
+      failing.onIteration(first, 20 - 50 * i);
+    }
+    if (steady.getScale() != 1) cout << "[FAIL] A settled search was given extra time" << endl;
+    else if (unstable.getScale() <= 1) cout << "[FAIL] Best move changes were not given extra time" << endl;
+    else if (failing.getScale() <= 1) cout << "[FAIL] A falling score was not given extra time" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- The clock only runs once started...";
+  {
+    TimeManager::Clock clock;
+    clock.movetime_ms = 1;
+    TimeManager time(clock);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    bool early = time.outOfTime(0);
+    time.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    if (early) cout << "[FAIL] Ran out of time before starting" << endl;
+    else if (!time.outOfTime(0)) cout << "[FAIL] Did not run out of time" << endl;
+    else cout << "[PASS]" << endl;
+  }
+
+  cout << "Testing evaluation...\n- Mirrored positions score the same...";
+  {
+    // each pair is a position & the same one with colors & ranks swapped
+    const char* pairs[][2] = {
+      { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1" },
+      { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 1" },
+      { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "8/4p1p1/8/1r3P1K/kp5R/3P4/2P5/8 b - - 0 1" },
+    };
+    bool passing = true;
+    for (auto& pair : pairs) {
+      Board board, mirrored;
+      board.setUp(pair[0]);
+      mirrored.setUp(pair[1]);
+      if (Eval::evaluate(board) != Eval::evaluate(mirrored)) passing = false;
+    }
+    if (passing) cout << "[PASS]" << endl;
+    else cout << "[FAIL] A position & its mirror scored differently" << endl;
+  }
+
+  cout << "- Mirrored positions score the same with pawn structure...";
+  {
+    const char* pairs[][2] = {
+      { "4k3/1p5p/8/2P5/2P5/8/P2P4/4K3 w - - 0 1",
+        "4k3/p2p4/8/2p5/2p5/8/1P5P/4K3 b - - 0 1" },
+      { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 1" },
+    };
+    Eval::PawnTable pawns(16);
+    bool passing = true;
+    for (auto& pair : pairs) {
+      Board board, mirrored;
+      board.setUp(pair[0]);
+      mirrored.setUp(pair[1]);
+      if (Eval::evaluate(board, pawns) != Eval::evaluate(mirrored, pawns)) passing = false;
+    }
+    if (passing) cout << "[PASS]" << endl;
+    else cout << "[FAIL] A position & its mirror scored differently" << endl;
+  }
+  cout << "- Passed pawns...";
+  {
+    // a2 & c5 are passed (c4 is behind c5), h7 is passed for black
+    Board board;
+    board.setUp("4k3/7p/8/2P5/2P5/8/P7/4K3 w - - 0 1");
+    Eval::PawnEntry pawns = Eval::evaluatePawns(board.getPieces(Piece::white_pawn)
+      , board.getPieces(Piece::black_pawn));
+    Bitboards::bb white_passed = Bitboards::idxToBoard(Indexing::a + Indexing::r2)
+      | Bitboards::idxToBoard(Indexing::c + Indexing::r5);
+    Bitboards::bb black_passed = Bitboards::idxToBoard(Indexing::h + Indexing::r7);
+    if (pawns.passed[true] != white_passed || pawns.passed[false] != black_passed)
+      cout << "[FAIL] Wrong passed pawns found" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Weak pawns are penalized...";
+  {
+    // the same pawns, healthy: on adjacent files & side by side
+    Eval::PawnEntry healthy = Eval::evaluatePawns(
+      Bitboards::idxToBoard(Indexing::d + Indexing::r4) | Bitboards::idxToBoard(Indexing::e + Indexing::r4), 0);
+    // doubled & isolated
+    Eval::PawnEntry doubled = Eval::evaluatePawns(
+      Bitboards::idxToBoard(Indexing::d + Indexing::r4) | Bitboards::idxToBoard(Indexing::d + Indexing::r3), 0);
+    // d3 can't advance past e5's attack on d4, & c-pawn is gone
+    Eval::PawnEntry backward = Eval::evaluatePawns(
+      Bitboards::idxToBoard(Indexing::d + Indexing::r3) | Bitboards::idxToBoard(Indexing::e + Indexing::r4)
+      , Bitboards::idxToBoard(Indexing::c + Indexing::r5));
+    Eval::PawnEntry supported = Eval::evaluatePawns(
+      Bitboards::idxToBoard(Indexing::d + Indexing::r3) | Bitboards::idxToBoard(Indexing::c + Indexing::r2)
+      | Bitboards::idxToBoard(Indexing::e + Indexing::r4), Bitboards::idxToBoard(Indexing::c + Indexing::r5));
+    if (doubled.score.eg >= healthy.score.eg)
+      cout << "[FAIL] Doubled, isolated pawns scored no worse than connected ones" << endl;
+    else if (backward.score.mg - supported.score.mg >= 0)
+      cout << "[FAIL] A backward pawn was not penalized" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Pawn key & pawn hash table...";
+  {
+    Board board;
+    board.setUp();
+    Eval::PawnTable pawns(16);
+    Zobrist::Key start = board.getPawnKey();
+    Eval::evaluate(board, pawns);
+    // a knight move leaves the pawns alone, so the entry is reused
+    Move nf3(Indexing::g + Indexing::r1, Indexing::f + Indexing::r3);
+    Board::Undo undo = board.makeMove(nf3);
+    bool same_key = board.getPawnKey() == start;
+    Eval::evaluate(board, pawns);
+    board.unmakeMove(nf3, undo);
+    Move e4(Indexing::e + Indexing::r2, Indexing::e + Indexing::r4, Move::en_passant);
+    undo = board.makeMove(e4);
+    bool new_key = board.getPawnKey() != start && board.getPawnKey() == board.computePawnKey();
+    board.unmakeMove(e4, undo);
+    if (!same_key || !new_key || board.getPawnKey() != start)
+      cout << "[FAIL] The pawn key did not follow the pawns" << endl;
+    else if (pawns.getStats().probes != 2 || pawns.getStats().hits != 1)
+      cout << "[FAIL] Expected 1 hit in 2 probes, got " << pawns.getStats().hits
+        << " in " << pawns.getStats().probes << endl;
+    else cout << "[PASS]" << endl;
+  }
+
+  cout << "Testing search...\n- Mate in one...";
+  {
+    Board board;
+    board.setUp("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    Limits limits;
+    limits.depth = 4;
+    Result result = search(board, limits, tt);
+    Move ra8(Indexing::a + Indexing::r1, Indexing::a + Indexing::r8);
+    if (result.best_move != ra8) cout << "[FAIL] Expected a1a8, got " << result.best_move.toUCI() << endl;
+    else if (result.score != score_mate - 1) cout << "[FAIL] Expected a mate-in-one score, got " << result.score << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Mate in two...";
+  {
+    // 1. Kb6 Kb8 2. Rh8#, but 1. Rh8+ lets the king out through a7
+    Board board;
+    board.setUp("k7/8/2K5/8/8/8/8/7R w - - 0 1");
+    Limits limits;
+    limits.depth = 5;
+    Result result = search(board, limits, tt);
+    if (result.score != score_mate - 3) cout << "[FAIL] Expected a mate-in-two score, got " << result.score << endl;
+    else if (result.pv.size() != 3) cout << "[FAIL] Expected a 3 move PV, got " << result.pv.size() << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Stalemate is a draw...";
+  {
+    Board board;
+    board.setUp("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    Result result = search(board, Limits(), tt);
+    if (!result.best_move.isNone() || result.score != score_draw)
+      cout << "[FAIL] Expected no move & a draw score, got " << result.score << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Each node is counted once...";
+  {
+    // the root & its only reply, which the quiescence search finds quiet
+    Board board;
+    board.setUp("7k/8/8/8/8/8/6r1/7K w - - 0 1");
+    tt.clear();
+    Limits limits;
+    limits.depth = 1;
+    Result result = search(board, limits, tt);
+    if (result.nodes != 2) cout << "[FAIL] Expected 2 nodes, got " << result.nodes << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Wins free material...";
+  {
+    Board board;
+    board.setUp("4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1");
+    Limits limits;
+    limits.depth = 3;
+    Result result = search(board, limits, tt);
+    Move rxd5(Indexing::d + Indexing::r1, Indexing::d + Indexing::r5);
+    if (result.best_move != rxd5) cout << "[FAIL] Expected d1d5, got " << result.best_move.toUCI() << endl;
+    else if (result.depth != 3 || result.pv.empty() || result.pv[0] != rxd5)
+      cout << "[FAIL] Depth or PV don't match the result" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Quiescence sees the recapture...";
+  {
+    // at depth 1, Qxd5 looks like a free pawn until exd5 is played out
+    Board board;
+    board.setUp("4k3/8/4p3/3p4/8/8/8/3QK3 w - - 0 1");
+    Limits limits;
+    limits.depth = 1;
+    Result result = search(board, limits, tt);
+    Move qxd5(Indexing::d + Indexing::r1, Indexing::d + Indexing::r5);
+    if (result.best_move == qxd5) cout << "[FAIL] Took a defended pawn with the queen" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Selectivity keeps the tactics...";
+  {
+    // the mate in two needs a quiet first move, & passing on the second
+    // move would hand black a free tempo; both must survive the pruning
+    Selectivity none{ false, false, false, false };
+    Board board;
+    board.setUp("k7/8/2K5/8/8/8/8/7R w - - 0 1");
+    Limits limits;
+    limits.depth = 6;
+    std::atomic<bool> stop(false);
+    Result pruned = search(board, limits, tt, stop, 1);
+    tt.clear();
+    Result full = search(board, limits, tt, stop, 1, none);
+    if (pruned.score != score_mate - 3 || full.score != score_mate - 3)
+      cout << "[FAIL] Expected mate-in-two scores, got " << pruned.score << " & " << full.score << endl;
+    else {
+      // & it has to pay for itself in a busy middlegame
+      board.setUp("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+      tt.clear();
+      pruned = search(board, limits, tt, stop, 1);
+      tt.clear();
+      full = search(board, limits, tt, stop, 1, none);
+      if (pruned.nodes >= full.nodes)
+        cout << "[FAIL] Pruning searched " << pruned.nodes << " nodes, no fewer than " << full.nodes << endl;
+      else cout << "[PASS]" << endl;
+    }
+  }
+  cout << "- Node limit stops the search...";
+  {
+    Board board;
+    board.setUp();
+    Limits limits;
+    limits.nodes = 50000;
+    Result result = search(board, limits, tt);
+    // the limit is only checked every few thousand nodes
+    if (result.nodes > limits.nodes + 0x1000) cout << "[FAIL] Searched " << result.nodes << " nodes" << endl;
+    else if (result.best_move.isNone() || !board.isLegal(result.best_move))
+      cout << "[FAIL] No legal best move after stopping" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Time limit stops the search...";
+  {
+    Board board;
+    board.setUp();
+    TimeManager::Clock clock;
+    clock.movetime_ms = 100;
+    TimeManager time(clock);
+    time.start();
+    Limits limits;
+    limits.time = &time;
+    auto start = std::chrono::steady_clock::now();
+    Result result = search(board, limits, tt);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() > 0.2) cout << "[FAIL] A 100ms search took " << elapsed.count() << "s" << endl;
+    else if (result.best_move.isNone() || !board.isLegal(result.best_move))
+      cout << "[FAIL] No legal best move after stopping" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- A single legal move is played at once...";
+  {
+    // g1 & h2 are covered by the rook, so Kxg2 is forced
+    Board board;
+    board.setUp("7k/8/8/8/8/8/6r1/7K w - - 0 1");
+    TimeManager::Clock clock;
+    clock.time_ms = 60000;
+    TimeManager time(clock);
+    time.start();
+    Limits limits;
+    limits.time = &time;
+    Result result = search(board, limits, tt);
+    if (result.best_move != Move(Indexing::h + Indexing::r1, Indexing::g + Indexing::r2) || result.depth != 1)
+      cout << "[FAIL] Expected h1g2 at depth 1, got " << result.best_move.toUCI()
+        << " at depth " << result.depth << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Lazy SMP agrees with one thread...";
+  {
+    Board board;
+    board.setUp("k7/8/2K5/8/8/8/8/7R w - - 0 1");
+    Limits limits;
+    limits.depth = 5;
+    std::atomic<bool> stop(false);
+    Result result = search(board, limits, tt, stop, 4);
+    if (result.score != score_mate - 3) cout << "[FAIL] Expected a mate-in-two score, got " << result.score << endl;
+    else if (result.depth < 3 || result.pv.empty() || result.pv[0] != result.best_move)
+      cout << "[FAIL] Result doesn't hold together" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Lazy SMP stops at the depth limit...";
+  {
+    // helpers with odd ids start a ply deeper, but mustn't go past the limit
+    Board board;
+    board.setUp("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    tt.clear();
+    Limits limits;
+    limits.depth = 4;
+    std::atomic<bool> stop(false);
+    // the main thread lingers after its last iteration, giving the helpers
+    // time to go deeper if nothing stops them
+    Result result = search(board, limits, tt, stop, 4, Selectivity(), [](const Result& iteration) {
+      if (iteration.depth == 4) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    });
+    bool past_limit = std::any_of(result.thread_depths.begin(), result.thread_depths.end()
+      , [](int depth) { return depth > 4; });
+    if (result.depth != 4) cout << "[FAIL] Expected depth 4, got " << result.depth << endl;
+    else if (result.thread_depths.size() != 4) cout << "[FAIL] Expected 4 threads' depths" << endl;
+    else if (past_limit) cout << "[FAIL] A helper searched past depth 4" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Stop flag ends every thread...";
+  {
+    Board board;
+    board.setUp();
+    std::atomic<bool> stop(false);
+    std::thread stopper([&stop]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      stop.store(true);
+    });
+    // without the flag this would run to the maximum depth
+    Result result = search(board, Limits(), tt, stop, 3);
+    stopper.join();
+    if (result.best_move.isNone() || !board.isLegal(result.best_move))
+      cout << "[FAIL] No legal best move after stopping" << endl;
+    else cout << "[PASS]" << endl;
+  }
+}
@@ -0,0 +1,75 @@
+#include "timeman.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace Search;
+
+namespace {
+  // a score this much below the last iteration's counts as a fail low
+  constexpr int score_drop = 30;
+  constexpr double max_scale = 3.0;
+  // bounds on the nodes between clock reads
+  constexpr uint64_t min_check_interval = 256;
+  constexpr uint64_t max_check_interval = 16384;
+
+  inline int64_t nowTicks() noexcept {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+  }
+}
+
+TimeManager::TimeManager() noexcept : soft_ms(-1), hard_ms(-1), start_ticks(nowTicks()), running(false)
+  , next_check(min_check_interval), last_best_move(Move::none()), last_score(0), iterations(0)
+  , instability(0), failed_low(false), scale(1) {}
+
+TimeManager::TimeManager(const Clock& clock) noexcept : TimeManager() {
+  if (clock.movetime_ms >= 0) {
+    // a fixed time is spent whole, with nothing to save up for
+    soft_ms = hard_ms = std::max<int64_t>(clock.movetime_ms - overhead_ms, 1);
+  }
+  else if (clock.time_ms >= 0) {
+    int64_t available = std::max<int64_t>(clock.time_ms - overhead_ms, 1);
+    int moves_to_go = (clock.moves_to_go > 0) ? std::min(clock.moves_to_go, 50) : default_moves_to_go;
+    int64_t base = clock.time_ms / moves_to_go + clock.increment_ms * 3 / 4;
+    // never so much of what is left that the next moves are starved
+    hard_ms = std::min(base * 4, available / 2 + clock.increment_ms / 2);
+    hard_ms = std::clamp<int64_t>(hard_ms, 1, available);
+    soft_ms = std::clamp<int64_t>(base / 2, 1, hard_ms);
+  }
+}
+
+void TimeManager::start() noexcept {
+  start_ticks.store(nowTicks(), std::memory_order_relaxed);
+  running.store(true, std::memory_order_release);
+}
+
+int64_t TimeManager::elapsedMs() const noexcept {
+  std::chrono::steady_clock::duration ticks(nowTicks() - start_ticks.load(std::memory_order_relaxed));
+  return std::chrono::duration_cast<std::chrono::milliseconds>(ticks).count();
+}
+
+bool TimeManager::outOfTime(uint64_t nodes) noexcept {
+  int64_t elapsed = elapsedMs();
+  // aim for about one check a millisecond at the rate seen so far
+  uint64_t per_ms = nodes / std::max<int64_t>(elapsed, 1);
+  next_check = nodes + std::clamp(per_ms, min_check_interval, max_check_interval);
+  return isLimited() && isRunning() && elapsed >= hard_ms;
+}
+
+bool TimeManager::onIteration(Move best_move, int score) noexcept {
+  ++iterations;
+  instability *= 0.5;
+  if (iterations > 1) {
+    if (best_move != last_best_move) instability += 1;
+    if (score < last_score - score_drop) failed_low = true;
+  }
+  last_best_move = best_move;
+  last_score = score;
+
+  scale = std::min(1 + instability * 0.5 + (failed_low ? 0.5 : 0), max_scale);
+  failed_low = false;
+  if (!isLimited() || !isRunning()) return true;
+  return elapsedMs() < std::min<int64_t>(static_cast<int64_t>(soft_ms * scale), hard_ms);
+}
+
+void TimeManager::onFailLow() noexcept { failed_low = true; }
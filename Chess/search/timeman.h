@@ -0,0 +1,87 @@
+#ifndef TIMEMAN_H
+#define TIMEMAN_H
+
+// defines the time manager: how long a timed search may think.
+// from the clock it works out a soft budget, after which no new iteration
+// is started, & a hard budget, after which the search is stopped mid-iteration.
+// the soft budget stretches when the best move keeps changing between
+// iterations or the score drops (the search hasn't settled, so more time
+// is worth the most there) & never goes past the hard one.
+// the clock is read only every so many nodes, sized from the node rate so
+// that checks come roughly once a millisecond however fast the search is
+//
+// For more info, read https://www.chessprogramming.org/Time_Management
+
+#include <atomic>
+#include <cstdint>
+
+#include "../board/movegen/move.h"
+
+namespace Search {
+  class TimeManager {
+  public:
+    // the time controls of the side to move, as given by "go" in UCI
+    struct Clock {
+      // the time left & added per move, or -1 for no clock
+      int64_t time_ms = -1;
+      int64_t increment_ms = 0;
+      // the moves left until the time control resets, 0 if it never does
+      int moves_to_go = 0;
+      // a fixed time for this move, or -1 for none (overrides the clock)
+      int64_t movetime_ms = -1;
+    };
+
+    // budgets nothing until a Clock is given
+    TimeManager() noexcept;
+    explicit TimeManager(const Clock& clock) noexcept;
+
+    // whether the clock puts any limit on the search
+    inline bool isLimited() const noexcept { return hard_ms >= 0; }
+    inline int64_t getSoftMs() const noexcept { return soft_ms; }
+    inline int64_t getHardMs() const noexcept { return hard_ms; }
+
+    // starts (or, on ponderhit, restarts) the clock; until then no budget
+    // runs out, so the search can ponder for as long as it likes
+    // safe to call from another thread while the search runs
+    void start() noexcept;
+    inline bool isRunning() const noexcept { return running.load(std::memory_order_acquire); }
+    int64_t elapsedMs() const noexcept;
+
+    // whether the hard budget has run out; call once the node count
+    // reaches nextCheck(), so the clock isn't read every node
+    bool outOfTime(uint64_t nodes) noexcept;
+    inline uint64_t nextCheck() const noexcept { return next_check; }
+
+    // called by the main thread after each finished iteration
+    // returns whether there is time for another one
+    bool onIteration(Move best_move, int score) noexcept;
+    // called when the root search fails low (the best move got worse)
+    void onFailLow() noexcept;
+    // how much of the soft budget to use, given how unsettled the search is
+    inline double getScale() const noexcept { return scale; }
+
+    // kept back from every budget for the GUI & the engine to talk
+    constexpr static inline int64_t overhead_ms = 30;
+    // the moves a clock without moves_to_go is spread over
+    constexpr static inline int default_moves_to_go = 30;
+
+  private:
+    int64_t soft_ms;
+    int64_t hard_ms;
+    // steady_clock ticks when the clock was started
+    std::atomic<int64_t> start_ticks;
+    std::atomic<bool> running;
+
+    uint64_t next_check;
+
+    Move last_best_move;
+    int last_score;
+    int iterations;
+    // decaying count of best move changes
+    double instability;
+    bool failed_low;
+    double scale;
+  };
+}
+
+#endif // TIMEMAN_H
@@ -0,0 +1,107 @@
+#include "tt.h"
+
+#include <climits>
+
+using Search::TranspositionTable;
+
+// the slots are independent words, so relaxed ordering is enough:
+// a torn read just fails the key ^ data check
+constexpr static std::memory_order relaxed = std::memory_order_relaxed;
+
+TranspositionTable::TranspositionTable(size_t mb) : buckets(), num_buckets(0), generation(0) {
+  resize(mb);
+}
+
+void TranspositionTable::resize(size_t mb) {
+  size_t max_buckets = (mb << 20) / sizeof(Bucket);
+  num_buckets = 1;
+  while (num_buckets * 2 <= max_buckets) num_buckets *= 2;
+  buckets.reset(new Bucket[num_buckets]);
+  clear();
+}
+
+void TranspositionTable::clear() noexcept {
+  for (size_t i = 0; i < num_buckets; ++i) {
+    for (Slot& slot : buckets[i].slots) {
+      slot.data.store(0, relaxed);
+      slot.check.store(0, relaxed);
+    }
+  }
+  generation = 0;
+}
+
+bool TranspositionTable::probe(Zobrist::Key key, Entry& out, Stats& stats) const noexcept {
+  ++stats.probes;
+  bool bucket_full = true;
+  for (Slot& slot : bucketFor(key).slots) {
+    uint64_t data = slot.data.load(relaxed);
+    uint64_t check = slot.check.load(relaxed);
+    if (!data) {
+      bucket_full = false;
+      continue;
+    }
+    if ((check ^ data) == key) {
+      out = unpack(data);
+      ++stats.hits;
+      return true;
+    }
+  }
+  if (bucket_full) ++stats.collisions;
+  return false;
+}
+
+void TranspositionTable::store(Zobrist::Key key, Move move, int score, int depth
+  , Bound bound, Stats& stats) noexcept {
+  ++stats.stores;
+  Slot* replace = nullptr;
+  bool evicting = false;
+  int lowest_value = INT_MAX;
+  for (Slot& slot : bucketFor(key).slots) {
+    uint64_t data = slot.data.load(relaxed);
+    uint64_t check = slot.check.load(relaxed);
+    if (!data) {
+      // an empty slot is only beaten by the position's own slot
+      if (lowest_value != INT_MIN) {
+        replace = &slot;
+        evicting = false;
+        lowest_value = INT_MIN;
+      }
+      continue;
+    }
+    if ((check ^ data) == key) {
+      Entry old = unpack(data);
+      // keep the old best move rather than forgetting it
+      if (move.getBits() == 0) move = old.move;
+      // don't let a shallow bound from this search clobber a deeper result
+      if (bound != bound_exact && getGeneration(data) == generation && depth < old.depth - 2) return;
+      replace = &slot;
+      evicting = false;
+      break;
+    }
+    // prefer replacing shallow entries & entries from older searches
+    int age = (generation - getGeneration(data)) & generation_mask;
+    int value = unpack(data).depth - 8 * age;
+    if (value < lowest_value) {
+      replace = &slot;
+      evicting = true;
+      lowest_value = value;
+    }
+  }
+
+  if (evicting) ++stats.overwrites;
+  uint64_t data = pack(move, score, depth, bound, generation);
+  replace->data.store(data, relaxed);
+  replace->check.store(key ^ data, relaxed);
+}
+
+int TranspositionTable::hashfull() const noexcept {
+  size_t sample = (num_buckets < 250) ? num_buckets : 250;
+  int used = 0;
+  for (size_t i = 0; i < sample; ++i) {
+    for (Slot& slot : buckets[i].slots) {
+      uint64_t data = slot.data.load(relaxed);
+      if (data && getGeneration(data) == generation) ++used;
+    }
+  }
+  return static_cast<int>(used * 1000 / (sample * bucket_size));
+}
@@ -0,0 +1,135 @@
+#ifndef TT_H
+#define TT_H
+
+// defines the transposition table: a fixed-size hash table of search results
+// keyed by the Zobrist key of the position.
+// it is shared between search threads without any locks; each slot stores
+// its key XORed with its data, so a slot torn by two racing writers simply
+// fails verification & reads as a miss
+//
+// For more info, read https://www.chessprogramming.org/Transposition_Table
+// and https://www.chessprogramming.org/Shared_Hash_Table#Lockless
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "../board/movegen/move.h"
+#include "../board/zobrist.h"
+
+namespace Search {
+  // how a stored score relates to the true score of the position
+  enum Bound : uint8_t {
+    bound_none = 0,
+    bound_upper = 1,  // the search failed low, true score <= score
+    bound_lower = 2,  // the search failed high, true score >= score
+    bound_exact = 3,
+  };
+
+  class TranspositionTable {
+  public:
+    // a decoded slot
+    struct Entry {
+      Move move;
+      int16_t score;
+      int8_t depth;
+      Bound bound;
+    };
+
+    // counters for tuning the table size & replacement scheme
+    // these are owned by the caller (one per search thread) so that
+    // counting never makes threads fight over a cache line
+    struct Stats {
+      uint64_t probes = 0;
+      uint64_t hits = 0;
+      // probes that missed while the bucket was full of other positions
+      uint64_t collisions = 0;
+      uint64_t stores = 0;
+      // stores that evicted a different position
+      uint64_t overwrites = 0;
+
+      inline Stats& operator+=(const Stats& rhs) noexcept {
+        probes += rhs.probes;
+        hits += rhs.hits;
+        collisions += rhs.collisions;
+        stores += rhs.stores;
+        overwrites += rhs.overwrites;
+        return *this;
+      }
+    };
+
+    explicit TranspositionTable(size_t mb = default_mb);
+
+    // reallocates the table to the largest power-of-two number of buckets
+    // that fits in mb megabytes, discarding every entry
+    // ! not thread-safe; no search may be running
+    void resize(size_t mb);
+    // empties every slot
+    // ! not thread-safe; no search may be running
+    void clear() noexcept;
+    // ages the table, so entries from earlier searches get replaced first
+    inline void newSearch() noexcept { generation = (generation + 1) & generation_mask; }
+
+    // looks up key, filling out if it is found
+    bool probe(Zobrist::Key key, Entry& out, Stats& stats) const noexcept;
+    // stores a search result for key, replacing the least valuable slot in its bucket
+    void store(Zobrist::Key key, Move move, int score, int depth, Bound bound
+      , Stats& stats) noexcept;
+
+    inline size_t getNumBuckets() const noexcept { return num_buckets; }
+    inline size_t getNumEntries() const noexcept { return num_buckets * bucket_size; }
+    inline size_t getSizeBytes() const noexcept { return num_buckets * sizeof(Bucket); }
+    // permille of a sample of slots written during the current search (for UCI)
+    int hashfull() const noexcept;
+
+    constexpr static inline size_t default_mb = 16;
+
+  private:
+    struct Slot {
+      std::atomic<uint64_t> check;  // key ^ data
+      std::atomic<uint64_t> data;
+    };
+    constexpr static inline size_t bucket_size = 4;
+    // one bucket fills one cache line, so a probe costs at most one miss
+    struct alignas(64) Bucket {
+      Slot slots[bucket_size];
+    };
+    static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+
+    // layout of the data word
+    //   bits 0-15   Move
+    //   bits 16-31  score
+    //   bits 32-39  depth
+    //   bits 40-41  Bound
+    //   bits 42-47  generation
+    constexpr static inline uint8_t generation_mask = 0x3f;
+    inline static uint64_t pack(Move move, int score, int depth
+      , Bound bound, uint8_t gen) noexcept {
+      return static_cast<uint64_t>(move.getBits())
+        | (static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16)
+        | (static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 32)
+        | (static_cast<uint64_t>(bound) << 40)
+        | (static_cast<uint64_t>(gen & generation_mask) << 42);
+    }
+    inline static Entry unpack(uint64_t data) noexcept {
+      return { Move::fromBits(static_cast<uint16_t>(data))
+        , static_cast<int16_t>(data >> 16)
+        , static_cast<int8_t>(data >> 32)
+        , static_cast<Bound>((data >> 40) & 0x3) };
+    }
+    constexpr static inline uint8_t getGeneration(uint64_t data) noexcept {
+      return (data >> 42) & generation_mask;
+    }
+
+    inline Bucket& bucketFor(Zobrist::Key key) const noexcept {
+      return buckets[key & (num_buckets - 1)];
+    }
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t num_buckets;
+    uint8_t generation;
+  };
+}
+
+#endif // TT_H
@@ -0,0 +1,22 @@
+// UCI engine
+//
+// speaks the Universal Chess Interface on stdin/stdout, for GUIs,
+// tournament managers & scripts
+//
+// usage:
+//   ChessUCI
+
+#include <iostream>
+#include <string>
+
+#include "uci.h"
+
+int main() {
+  std::ios::sync_with_stdio(false);
+  UCI::Engine engine(std::cout);
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    if (!engine.handle(line)) break;
+  }
+  return 0;
+}
@@ -0,0 +1,204 @@
+#include "uci.h"
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using std::cout, std::endl;
+
+namespace {
+  // collects the engine's output, & can be read while the worker writes
+  // (xsputn may call overflow, so the lock has to be recursive)
+  class SharedBuffer : public std::stringbuf {
+  public:
+    std::string snapshot() {
+      std::lock_guard<std::recursive_mutex> guard(lock);
+      return str();
+    }
+
+  protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+      std::lock_guard<std::recursive_mutex> guard(lock);
+      return std::stringbuf::xsputn(s, n);
+    }
+    int_type overflow(int_type c) override {
+      std::lock_guard<std::recursive_mutex> guard(lock);
+      return std::stringbuf::overflow(c);
+    }
+
+  private:
+    std::recursive_mutex lock;
+  };
+
+  // the text after "bestmove " on the last bestmove line, or "" if none
+  std::string lastBestMove(const std::string& output) {
+    size_t at = output.rfind("bestmove ");
+    if (at == std::string::npos) return "";
+    size_t start = at + 9;
+    return output.substr(start, output.find_first_of(" \n", start) - start);
+  }
+}
+
+int main() {
+  cout << "Testing UCI...\n- Handshake...";
+  {
+    std::ostringstream out;
+    UCI::Engine engine(out);
+    engine.handle("uci");
+    engine.handle("isready");
+    std::string text = out.str();
+    if (text.find("id name") == std::string::npos || text.find("option name Hash") == std::string::npos
+      || text.find("option name Threads") == std::string::npos)
+      cout << "[FAIL] Missing id or options:\n" << text << endl;
+    else if (text.find("uciok") == std::string::npos || text.find("readyok") == std::string::npos)
+      cout << "[FAIL] Missing uciok or readyok:\n" << text << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Position with moves & go depth...";
+  {
+    std::ostringstream out;
+    UCI::Engine engine(out);
+    engine.handle("setoption name Hash value 4");
+    engine.handle("setoption name Threads value 2");
+    engine.handle("position startpos moves e2e4 e7e5 g1f3");
+    engine.handle("go depth 4");
+    engine.waitForSearch();
+    Board board;
+    board.setUp("rnbqkbnr/pppp1ppp/8/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 2");
+    std::string best = lastBestMove(out.str());
+    if (out.str().find("info depth 4") == std::string::npos)
+      cout << "[FAIL] No info line for depth 4:\n" << out.str() << endl;
+    else if (UCI::parseMove(board, best).isNone())
+      cout << "[FAIL] bestmove " << best << " is not a legal reply for black" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Mate scores...";
+  {
+    std::ostringstream out;
+    UCI::Engine engine(out);
+    engine.handle("position fen 6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    engine.handle("go depth 3");
+    engine.waitForSearch();
+    if (out.str().find("score mate 1") == std::string::npos || lastBestMove(out.str()) != "a1a8")
+      cout << "[FAIL] Expected a1a8 with a mate in 1 score:\n" << out.str() << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Repeats a position from the game to draw...";
+  {
+    // black is a queen for a rook down, but Kh8 brings back the position
+    // after 1. Kh1 Kh8, so the game is a draw by repetition
+    std::ostringstream out;
+    UCI::Engine engine(out);
+    engine.handle("position fen r5k1/5ppp/8/8/8/8/5PPP/3Q2K1 w - - 0 1 moves g1h1 g8h8 h1g1 h8g8 g1h1");
+    engine.handle("go depth 4");
+    engine.waitForSearch();
+    std::string text = out.str();
+    size_t last_info = text.rfind("info depth");
+    if (lastBestMove(text) != "g8h8" || last_info == std::string::npos
+      || text.compare(text.find("score ", last_info), 10, "score cp 0") != 0)
+      cout << "[FAIL] Expected g8h8 with a draw score:\n" << text << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Infinite search waits for stop...";
+  {
+    SharedBuffer buffer;
+    std::ostream out(&buffer);
+    UCI::Engine engine(out);
+    // the search ends at once (mate in 1), but the bestmove has to wait
+    engine.handle("position fen 6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    engine.handle("go infinite");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bool early = !lastBestMove(buffer.snapshot()).empty();
+    auto start = std::chrono::steady_clock::now();
+    engine.handle("stop");
+    std::chrono::duration<double> latency = std::chrono::steady_clock::now() - start;
+    if (early) cout << "[FAIL] Sent bestmove before stop" << endl;
+    else if (lastBestMove(buffer.snapshot()) != "a1a8") cout << "[FAIL] Expected bestmove a1a8 after stop" << endl;
+    else if (latency.count() > 0.5) cout << "[FAIL] stop took " << latency.count() << "s" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Stop ends a long search quickly...";
+  {
+    std::ostringstream out;
+    UCI::Engine engine(out);
+    engine.handle("position startpos");
+    engine.handle("go infinite");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto start = std::chrono::steady_clock::now();
+    engine.handle("stop");
+    std::chrono::duration<double> latency = std::chrono::steady_clock::now() - start;
+    if (lastBestMove(out.str()).empty()) cout << "[FAIL] No bestmove after stop" << endl;
+    else if (latency.count() > 0.5) cout << "[FAIL] stop took " << latency.count() << "s" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Ponderhit starts the clock...";
+  {
+    SharedBuffer buffer;
+    std::ostream out(&buffer);
+    UCI::Engine engine(out);
+    engine.handle("position startpos moves e2e4");
+    engine.handle("go ponder movetime 100");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    bool early = !lastBestMove(buffer.snapshot()).empty();
+    auto start = std::chrono::steady_clock::now();
+    engine.handle("ponderhit");
+    engine.waitForSearch();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (early) cout << "[FAIL] Sent bestmove while pondering" << endl;
+    else if (lastBestMove(buffer.snapshot()).empty()) cout << "[FAIL] No bestmove after ponderhit" << endl;
+    else if (elapsed.count() < 0.05 || elapsed.count() > 1)
+      cout << "[FAIL] Expected about 100ms after ponderhit, took " << elapsed.count() << "s" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- A stray ponderhit leaves the clock alone...";
+  {
+    SharedBuffer buffer;
+    std::ostream out(&buffer);
+    UCI::Engine engine(out);
+    engine.handle("position startpos");
+    auto start = std::chrono::steady_clock::now();
+    engine.handle("go movetime 400");
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    // the search wasn't started with "go ponder", so this must be ignored
+    engine.handle("ponderhit");
+    engine.waitForSearch();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (lastBestMove(buffer.snapshot()).empty()) cout << "[FAIL] No bestmove" << endl;
+    else if (elapsed.count() > 0.6)
+      cout << "[FAIL] Expected about 400ms, took " << elapsed.count() << "s" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Clock time...";
+  {
+    std::ostringstream out;
+    UCI::Engine engine(out);
+    engine.handle("position startpos");
+    auto start = std::chrono::steady_clock::now();
+    engine.handle("go wtime 3000 btime 3000 winc 0 binc 0");
+    engine.waitForSearch();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (lastBestMove(out.str()).empty()) cout << "[FAIL] No bestmove" << endl;
+    else if (elapsed.count() > 1) cout << "[FAIL] Spent " << elapsed.count() << "s of a 3s clock" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  cout << "- Bad input is reported, not fatal...";
+  {
+    std::ostringstream out;
+    UCI::Engine engine(out);
+    engine.handle("position startpos moves e2e5");
+    engine.handle("position fen not a fen");
+    engine.handle("setoption name Hash value lots");
+    engine.handle("bogus command");
+    bool keeps_going = engine.handle("isready");
+    bool quits = !engine.handle("quit");
+    std::string text = out.str();
+    if (text.find("illegal move e2e5") == std::string::npos || text.find("invalid fen") == std::string::npos
+      || text.find("invalid value") == std::string::npos)
+      cout << "[FAIL] Errors were not reported:\n" << text << endl;
+    else if (!keeps_going || !quits) cout << "[FAIL] Expected to run until quit" << endl;
+    else cout << "[PASS]" << endl;
+  }
+  return 0;
+}
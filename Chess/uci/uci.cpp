@@ -0,0 +1,237 @@
+#include "uci.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+using namespace UCI;
+
+namespace {
+  const char* const engine_name = "Chess";
+  const char* const engine_author = "the Chess authors";
+}
+
+Move UCI::parseMove(const Board& board, const std::string& text) noexcept {
+  MoveList moves;
+  board.getAllMoves(moves);
+  for (Move move : moves) {
+    if (move.toUCI() == text) return move;
+  }
+  return Move::none();
+}
+
+Engine::Engine(std::ostream& out) : out(out), out_lock(), board(), history(), tt()
+  , num_threads(1), worker(), time(), stop(false), threads(tt, stop), state_lock(), state_changed()
+  , hold_bestmove(false), pondering(false), search_done(true) {
+  board.setUp();
+}
+
+Engine::~Engine() { stopSearch(); }
+
+void Engine::send(const std::string& line) {
+  std::lock_guard<std::mutex> guard(out_lock);
+  out << line << std::endl;
+}
+
+bool Engine::handle(const std::string& line) {
+  std::istringstream args(line);
+  std::string command;
+  args >> command;
+  if (command == "uci") uci();
+  else if (command == "isready") send("readyok");
+  else if (command == "setoption") setOption(args);
+  else if (command == "ucinewgame") {
+    stopSearch();
+    tt.clear();
+    threads.clear();
+  }
+  else if (command == "position") position(args);
+  else if (command == "go") go(args);
+  else if (command == "stop") stopSearch();
+  else if (command == "ponderhit") ponderHit();
+  else if (command == "quit") {
+    stopSearch();
+    return false;
+  }
+  // anything else (including blank lines) is ignored, as UCI asks
+  return true;
+}
+
+void Engine::uci() {
+  send(std::string("id name ") + engine_name);
+  send(std::string("id author ") + engine_author);
+  send("option name Hash type spin default " + std::to_string(Search::TranspositionTable::default_mb)
+    + " min 1 max " + std::to_string(max_hash_mb));
+  send("option name Threads type spin default 1 min 1 max " + std::to_string(max_threads));
+  send("option name Ponder type check default false");
+  send("uciok");
+}
+
+void Engine::setOption(std::istringstream& args) {
+  // setoption name <id> [value <x>]
+  std::string token, name, value;
+  args >> token;
+  while (args >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+  args >> value;
+
+  if (name == "Hash" || name == "Threads") {
+    long long number = 0;
+    try { number = std::stoll(value); }
+    catch (const std::exception&) {
+      send("info string invalid value for " + name + ": " + value);
+      return;
+    }
+    // the table can't be resized while a search is using it
+    stopSearch();
+    if (name == "Hash") tt.resize(static_cast<size_t>(std::clamp<long long>(number, 1, max_hash_mb)));
+    else num_threads = static_cast<int>(std::clamp<long long>(number, 1, max_threads));
+  }
+  // Ponder only tells the engine the GUI may ponder; nothing to set up
+  else if (name != "Ponder") send("info string unknown option " + name);
+}
+
+void Engine::position(std::istringstream& args) {
+  // position [startpos | fen <fen>] [moves <move> ...]
+  stopSearch();
+  std::string token;
+  args >> token;
+  Board next;
+  if (token == "startpos") {
+    next.setUp();
+    args >> token;
+  }
+  else if (token == "fen") {
+    std::string fen;
+    while (args >> token && token != "moves") fen += token + " ";
+    Board::FenError error = next.parseFen(fen.c_str());
+    if (error != Board::FenError::none) {
+      send(std::string("info string invalid fen: ") + Board::describe(error));
+      return;
+    }
+  }
+  else {
+    send("info string expected startpos or fen");
+    return;
+  }
+
+  std::vector<Zobrist::Key> played;
+  if (token == "moves") {
+    while (args >> token) {
+      Move move = parseMove(next, token);
+      if (move.isNone()) {
+        send("info string illegal move " + token);
+        return;
+      }
+      played.push_back(next.getKey());
+      next.makeMove(move);
+      // nothing before a capture or pawn move can come again
+      if (!next.getHalfmoveClock()) played.clear();
+    }
+  }
+  board = next;
+  history = std::move(played);
+}
+
+void Engine::go(std::istringstream& args) {
+  stopSearch();
+
+  Search::Limits limits;
+  limits.history = history;
+  Search::TimeManager::Clock white, black;
+  int64_t movetime = -1;
+  int movestogo = 0;
+  bool infinite = false, ponder = false;
+  std::string token;
+  while (args >> token) {
+    if (token == "infinite") infinite = true;
+    else if (token == "ponder") ponder = true;
+    else if (token == "depth") args >> limits.depth;
+    else if (token == "nodes") args >> limits.nodes;
+    else if (token == "movetime") args >> movetime;
+    else if (token == "wtime") args >> white.time_ms;
+    else if (token == "btime") args >> black.time_ms;
+    else if (token == "winc") args >> white.increment_ms;
+    else if (token == "binc") args >> black.increment_ms;
+    else if (token == "movestogo") args >> movestogo;
+  }
+  limits.depth = std::clamp(limits.depth, 1, Search::max_ply - 1);
+
+  Search::TimeManager::Clock clock = (board.isWhitesMove()) ? white : black;
+  clock.moves_to_go = movestogo;
+  clock.movetime_ms = movetime;
+  time = std::make_unique<Search::TimeManager>(clock);
+  if (time->isLimited() && !infinite) limits.time = time.get();
+  // a ponder search runs on the opponent's time, until ponderhit
+  if (!ponder) time->start();
+
+  {
+    std::lock_guard<std::mutex> guard(state_lock);
+    hold_bestmove = infinite || ponder;
+    pondering = ponder;
+    search_done = false;
+  }
+  stop.store(false);
+
+  Board root(board);
+  worker = std::thread([this, root, limits]() {
+    Search::Result result = threads.search(root, limits, num_threads
+      , [this](const Search::Result& iteration) { sendInfo(iteration); });
+    {
+      // UCI forbids the bestmove before "stop" or "ponderhit" in these modes
+      std::unique_lock<std::mutex> lock(state_lock);
+      state_changed.wait(lock, [this]() { return !hold_bestmove; });
+      search_done = true;
+    }
+    state_changed.notify_all();
+
+    std::string line = "bestmove " + ((result.best_move.isNone()) ? "0000" : result.best_move.toUCI());
+    if (result.pv.size() > 1) line += " ponder " + result.pv[1].toUCI();
+    send(line);
+  });
+}
+
+void Engine::ponderHit() {
+  {
+    std::lock_guard<std::mutex> guard(state_lock);
+    // a stray ponderhit would restart the clock of a timed search
+    if (search_done || !pondering) return;
+    // the opponent played the expected move, so the search is now for real
+    pondering = false;
+    hold_bestmove = false;
+  }
+  if (time) time->start();
+  state_changed.notify_all();
+}
+
+void Engine::stopSearch() {
+  stop.store(true);
+  {
+    std::lock_guard<std::mutex> guard(state_lock);
+    hold_bestmove = false;
+  }
+  state_changed.notify_all();
+  if (worker.joinable()) worker.join();
+}
+
+void Engine::waitForSearch() {
+  if (worker.joinable()) worker.join();
+}
+
+void Engine::sendInfo(const Search::Result& result) {
+  std::string line = "info depth " + std::to_string(result.depth) + " score ";
+  if (Search::isMateScore(result.score)) {
+    // in moves, not plies; negative when the engine is getting mated
+    int plies = Search::score_mate - std::abs(result.score);
+    int moves = (plies + 1) / 2;
+    line += "mate " + std::to_string((result.score > 0) ? moves : -moves);
+  }
+  else line += "cp " + std::to_string(result.score);
+  int64_t ms = static_cast<int64_t>(result.seconds * 1000);
+  line += " nodes " + std::to_string(result.nodes)
+    + " nps " + std::to_string(static_cast<uint64_t>(result.nodesPerSecond()))
+    + " time " + std::to_string(ms)
+    + " hashfull " + std::to_string(tt.hashfull()) + " pv";
+  for (Move move : result.pv) line += " " + move.toUCI();
+  send(line);
+}
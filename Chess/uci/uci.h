@@ -0,0 +1,92 @@
+#ifndef UCI_H
+#define UCI_H
+
+// defines the engine side of the Universal Chess Interface: a text protocol
+// spoken over stdin/stdout that lets GUIs, tournament managers & scripts
+// drive the engine.
+// commands are handled one line at a time on the caller's (I/O) thread;
+// "go" starts the search on a worker thread & returns at once, so "stop",
+// "ponderhit" & "isready" are answered while the search is still running
+//
+// For more info, read https://www.chessprogramming.org/UCI
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../board/board.h"
+#include "../search/search.h"
+
+namespace UCI {
+  // parses a move in long algebraic notation (e.g. "e2e4", "e7e8q")
+  // returns Move::none() if it isn't a legal move on board
+  Move parseMove(const Board& board, const std::string& text) noexcept;
+
+  class Engine {
+  public:
+    // everything the engine says is written to out, a line at a time
+    explicit Engine(std::ostream& out);
+    // stops any search that is still running
+    ~Engine();
+
+    // handles one line of input
+    // returns false once the GUI has asked the engine to quit
+    bool handle(const std::string& line);
+
+    // blocks until the current search (if any) has sent its bestmove
+    // ! the search must be one that ends on its own, not infinite or pondering
+    void waitForSearch();
+
+    constexpr static inline int max_threads = 64;
+    constexpr static inline int max_hash_mb = 4096;
+
+  private:
+    std::ostream& out;
+    std::mutex out_lock;
+
+    Board board;
+    // the keys of the positions played before board, back to the last
+    // capture or pawn move, so the search can spot repetitions of the game
+    std::vector<Zobrist::Key> history;
+    Search::TranspositionTable tt;
+    int num_threads;
+
+    // the search runs on worker, & watches the clock through time
+    std::thread worker;
+    std::unique_ptr<Search::TimeManager> time;
+    std::atomic<bool> stop;
+    // kept between searches, so the pawn & move ordering tables stay warm
+    Search::Threads threads;
+    // guards the flags below, which wake the worker
+    std::mutex state_lock;
+    std::condition_variable state_changed;
+    // in "go infinite" & "go ponder" the bestmove has to wait for the
+    // GUI's "stop" or "ponderhit", even if the search ends by itself
+    bool hold_bestmove;
+    // whether the search was started with "go ponder" & is still waiting
+    // for its ponderhit, which is ignored at any other time
+    bool pondering;
+    bool search_done;
+
+    // writes one line to out, whichever thread it comes from
+    void send(const std::string& line);
+
+    void uci();
+    void setOption(std::istringstream& args);
+    void position(std::istringstream& args);
+    void go(std::istringstream& args);
+    void ponderHit();
+    // ends the search (if any) & waits for its bestmove
+    void stopSearch();
+    void sendInfo(const Search::Result& result);
+  };
+}
+
+#endif // UCI_H
@@ -8,6 +8,21 @@
 #include <climits>
 #include <type_traits>
 
+// pick the fastest way to count & scan bits that the compiler offers:
+// C++20's <bit> where available, otherwise the GCC/Clang builtins
+// (which compile to popcnt/tzcnt/lzcnt or bsf/bsr), otherwise the portable
+// constexpr versions below
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<bit>)
+#include <bit>
+#endif
+#endif
+#if defined(__cpp_lib_bitops)
+#define BINARY_HW_BITOPS_STD 1
+#elif defined(__GNUC__) || defined(__clang__)
+#define BINARY_HW_BITOPS_BUILTIN 1
+#endif
+
 namespace Binary {
   using namespace std;
   template<class Lambda, class integral, integral = (Lambda{}(), 0) >
@@ -72,8 +87,9 @@ namespace Binary {
   }
 
   // Counts the number of bits in x that are set to 1
+  // (portable version, for when no intrinsic is available)
   template <class numeric>
-  constexpr enable_if_t<VALID_NUMERIC::value, int> countSetBits(numeric x) noexcept {
+  constexpr enable_if_t<VALID_NUMERIC::value, int> countSetBitsPortable(numeric x) noexcept {
     if (!x) return 0;
     else if (!(x &= (x - 1))) return 1; // set LS1B to 0 by two's-complement magic
 
@@ -86,6 +102,21 @@ namespace Binary {
     } 
     return count;
   }
+  // Counts the number of bits in x that are set to 1
+  template <class numeric>
+  constexpr inline enable_if_t<VALID_NUMERIC::value, int> countSetBits(numeric x) noexcept {
+    if constexpr (is_integral_v<numeric> && NUMERIC_BIT <= 64) {
+      using unsigned_t = make_unsigned_t<numeric>;
+#if defined(BINARY_HW_BITOPS_STD)
+      return std::popcount(static_cast<unsigned_t>(x));
+#elif defined(BINARY_HW_BITOPS_BUILTIN)
+      return __builtin_popcountll(static_cast<unsigned_t>(x));
+#else
+      return countSetBitsPortable(x);
+#endif
+    }
+    else return countSetBitsPortable(x);
+  }
 
   // isolates the most significant 1 bit in x
   template <class numeric>
@@ -130,9 +161,10 @@ namespace Binary {
 
   // finds the index of the most significant 1 bit in x
   // relative to the least significant possible bit (rightmost bit)
+  // (portable version, for when no intrinsic is available)
   template <class numeric>
   constexpr inline enable_if_t<VALID_NUMERIC::value,
-    int> indexOfMS1B(numeric x) noexcept {
+    int> indexOfMS1BPortable(numeric x) noexcept {
     if (!x) return NUMERIC_BIT + 1;
 
     int ms1b_idx = 0;
@@ -186,12 +218,56 @@ namespace Binary {
     return ms1b_idx;
   }
 
+  // finds the index of the most significant 1 bit in x
+  // relative to the least significant possible bit (rightmost bit)
+  // ! returns an out-of-range index if x is 0
+  template <class numeric>
+  constexpr inline enable_if_t<VALID_NUMERIC::value,
+    int> indexOfMS1B(numeric x) noexcept {
+    if constexpr (is_integral_v<numeric> && NUMERIC_BIT <= 64) {
+      if (!x) return NUMERIC_BIT + 1;
+      using unsigned_t = make_unsigned_t<numeric>;
+#if defined(BINARY_HW_BITOPS_STD)
+      return NUMERIC_BIT - 1 - std::countl_zero(static_cast<unsigned_t>(x));
+#elif defined(BINARY_HW_BITOPS_BUILTIN)
+      return 63 - __builtin_clzll(static_cast<unsigned_t>(x));
+#else
+      return indexOfMS1BPortable(x);
+#endif
+    }
+    else return indexOfMS1BPortable(x);
+  }
+
   // finds the index of the least significant 1 bit in x
   // relative to the least significant possible bit (rightmost bit)
+  // ! returns an out-of-range index if x is 0
   template <class numeric>
   constexpr inline enable_if_t<VALID_NUMERIC::value,
     int> indexOfLS1B(numeric x) noexcept {
-    return indexOfMS1B(isolateLS1B(x));
+    if constexpr (is_integral_v<numeric> && NUMERIC_BIT <= 64) {
+      if (!x) return NUMERIC_BIT + 1;
+      using unsigned_t = make_unsigned_t<numeric>;
+#if defined(BINARY_HW_BITOPS_STD)
+      return std::countr_zero(static_cast<unsigned_t>(x));
+#elif defined(BINARY_HW_BITOPS_BUILTIN)
+      return __builtin_ctzll(static_cast<unsigned_t>(x));
+#else
+      return indexOfMS1BPortable(isolateLS1B(x));
+#endif
+    }
+    else return indexOfMS1BPortable(isolateLS1B(x));
+  }
+
+  // finds the index of the least significant 1 bit in x, then resets that bit
+  // this is the fastest way to visit every set bit:
+  //   while (x) { int idx = popLS1B(&x); ... }
+  // ! x must not be 0
+  template <class numeric>
+  constexpr inline enable_if_t<VALID_NUMERIC::value,
+    int> popLS1B(numeric* x) noexcept {
+    int idx = indexOfLS1B(*x);
+    *x &= *x - 1;
+    return idx;
   }
 
   #undef VALID_NUMERIC
@@ -203,4 +279,7 @@ namespace Binary {
   #undef U_INT_BIT
 }
 
+#undef BINARY_HW_BITOPS_STD
+#undef BINARY_HW_BITOPS_BUILTIN
+
 #endif